@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// One set of the parameters read from constraints.yaml.
+struct ConstraintSet {
+    double p0;
+    double pe;
+    double v0;
+    double ve;
+    double amax;
+    double vmax;
+    double t0;
+    double dt;
+};
+
+// Deterministic random generator of ConstraintSet values for benchmarks and
+// parameter sweeps. The same seed always yields the same sequence.
+class ConstraintSweep {
+private:
+    std::mt19937_64 _rng;
+    std::uniform_real_distribution<double> _position;
+    std::uniform_real_distribution<double> _amax;
+    std::uniform_real_distribution<double> _vmax;
+    std::uniform_real_distribution<double> _t0;
+    std::uniform_real_distribution<double> _unit;
+    double _boundaryVelocityRatio;
+    double _dt;
+
+public:
+    // Positions are drawn from [-positionRange, positionRange], and the
+    // boundary velocities from +-boundaryVelocityRatio * vmax.
+    ConstraintSweep(const std::uint64_t seed = 0,
+                    const double positionRange = 10.0,
+                    const double amaxMin = 0.1, const double amaxMax = 5.0,
+                    const double vmaxMin = 0.2, const double vmaxMax = 10.0,
+                    const double boundaryVelocityRatio = 0.5,
+                    const double t0Range = 10.0,
+                    const double dt = 0.001)
+        : _rng(seed),
+          _position(-positionRange, positionRange),
+          _amax(amaxMin, amaxMax),
+          _vmax(vmaxMin, vmaxMax),
+          _t0(-t0Range, t0Range),
+          _unit(-1.0, 1.0),
+          _boundaryVelocityRatio(boundaryVelocityRatio),
+          _dt(dt) {}
+
+    ConstraintSet next() {
+        ConstraintSet c;
+        c.p0 = _position(_rng);
+        c.pe = _position(_rng);
+        c.amax = _amax(_rng);
+        c.vmax = _vmax(_rng);
+        c.v0 = _unit(_rng) * _boundaryVelocityRatio * c.vmax;
+        c.ve = _unit(_rng) * _boundaryVelocityRatio * c.vmax;
+        c.t0 = _t0(_rng);
+        c.dt = _dt;
+        return c;
+    }
+
+    std::vector<ConstraintSet> generate(const std::size_t count) {
+        std::vector<ConstraintSet> sets;
+        sets.reserve(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            sets.push_back(next());
+        }
+        return sets;
+    }
+};
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <yaml-cpp/yaml.h>
+
+#include "../two_points_interpolation_binary_io.hpp"
+#include "../two_points_interpolation_constant_acc_parallel.hpp"
+#include "constraints_sweep.hpp"
+
+// Plans every constraint set of a YAML sequence or CSV file in one process
+// and writes one CSV line per move.
+//
+//   ./TwoPointsInterpolationBatch <moves.yaml|moves.csv> [result.csv] [threads] [envelopes.bin] [buckets]
+//
+// YAML: a sequence of maps with the keys of constraints.yaml (v0, ve, t0 and
+// dt default to 0). CSV: a header line naming the same columns, then one move
+// per line.
+//
+// With envelopes.bin, the min/max envelopes of all moves (buckets per move,
+// default 1024) also go into one envelope file (see
+// two_points_interpolation_binary_io.hpp) for drawing the whole batch.
+
+namespace {
+
+bool endsWith(const std::string& s, const std::string& suffix) {
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+double valueOr(const YAML::Node& node, const char* key, const double fallback) {
+    return node[key] ? node[key].as<double>() : fallback;
+}
+
+bool loadConstraintsFromYamlSequence(const std::string& filePath, std::vector<ConstraintSet>& sets) {
+    try {
+        const YAML::Node config = YAML::LoadFile(filePath);
+        if (!config.IsSequence()) {
+            std::cerr << "Expected a YAML sequence of constraint sets in " << filePath << std::endl;
+            return false;
+        }
+        for (const YAML::Node& node : config) {
+            ConstraintSet c;
+            c.p0 = node["p0"].as<double>();
+            c.pe = node["pe"].as<double>();
+            c.amax = node["amax"].as<double>();
+            c.vmax = node["vmax"].as<double>();
+            c.v0 = valueOr(node, "v0", 0.0);
+            c.ve = valueOr(node, "ve", 0.0);
+            c.t0 = valueOr(node, "t0", 0.0);
+            c.dt = valueOr(node, "dt", 0.0);
+            sets.push_back(c);
+        }
+        return true;
+    } catch (const YAML::Exception& e) {
+        std::cerr << "Failed to load constraints from YAML: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool loadConstraintsFromCsv(const std::string& filePath, std::vector<ConstraintSet>& sets) {
+    std::ifstream file(filePath);
+    std::string line;
+    if (!std::getline(file, line)) {
+        std::cerr << "Failed to read the CSV header of " << filePath << std::endl;
+        return false;
+    }
+
+    const char* names[] = {"p0", "pe", "v0", "ve", "amax", "vmax", "t0", "dt"};
+    const std::size_t fieldCount = sizeof(names) / sizeof(names[0]);
+    std::vector<int> fieldOfColumn;
+    std::vector<bool> present(fieldCount, false);
+    std::stringstream header(line);
+    std::string name;
+    while (std::getline(header, name, ',')) {
+        name.erase(std::remove_if(name.begin(), name.end(), ::isspace), name.end());
+        int field = -1;
+        for (std::size_t f = 0; f < fieldCount; ++f) {
+            if (name == names[f]) {
+                field = static_cast<int>(f);
+                present[f] = true;
+            }
+        }
+        fieldOfColumn.push_back(field);
+    }
+    if (!present[0] || !present[1] || !present[4] || !present[5]) {
+        std::cerr << "The CSV header of " << filePath << " needs p0, pe, amax and vmax" << std::endl;
+        return false;
+    }
+
+    std::size_t lineNumber = 1;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        double values[fieldCount] = {};
+        const char* cursor = line.c_str();
+        for (std::size_t column = 0; column < fieldOfColumn.size(); ++column) {
+            char* end = nullptr;
+            const double value = std::strtod(cursor, &end);
+            if (end == cursor) {
+                std::cerr << "Malformed value in column " << column + 1 << " of line " << lineNumber << std::endl;
+                return false;
+            }
+            if (fieldOfColumn[column] >= 0) {
+                values[fieldOfColumn[column]] = value;
+            }
+            cursor = end;
+            while (*cursor == ' ' || *cursor == '\t' || *cursor == ',') {
+                ++cursor;
+            }
+        }
+        ConstraintSet c;
+        c.p0 = values[0];
+        c.pe = values[1];
+        c.v0 = values[2];
+        c.ve = values[3];
+        c.amax = values[4];
+        c.vmax = values[5];
+        c.t0 = values[6];
+        c.dt = values[7];
+        sets.push_back(c);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cout << "Usage: ./TwoPointsInterpolationBatch <moves.yaml|moves.csv> [result.csv] [threads]"
+                     " [envelopes.bin] [buckets]" << std::endl;
+        return 1;
+    }
+
+    const std::string inputPath = argv[1];
+    const std::string outputPath = argc > 2 ? argv[2] : "batch_result.csv";
+    const unsigned threadCount = argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(argv[3]))) : 1;
+    const std::string envelopePath = argc > 4 ? argv[4] : "";
+    const std::size_t bucketCount = argc > 5 ? static_cast<std::size_t>(std::max(1, std::atoi(argv[5]))) : 1024;
+
+    // Load constraints
+    std::vector<ConstraintSet> sets;
+    const bool loaded = endsWith(inputPath, ".csv") ? loadConstraintsFromCsv(inputPath, sets)
+                                                    : loadConstraintsFromYamlSequence(inputPath, sets);
+    if (!loaded) {
+        return 1;
+    }
+
+    // Plan in parallel; every move's result has its own slot, so the output
+    // does not depend on the number of threads.
+    const std::size_t n = sets.size();
+    std::vector<double> p0(n), pe(n), v0(n), ve(n), amax(n), vmax(n), t0(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        p0[i] = sets[i].p0;
+        pe[i] = sets[i].pe;
+        v0[i] = sets[i].v0;
+        ve[i] = sets[i].ve;
+        amax[i] = sets[i].amax;
+        vmax[i] = sets[i].vmax;
+        t0[i] = sets[i].t0;
+    }
+    std::vector<ConstantAccTrajectory> trajectories(n);
+    std::vector<int> caseNum(n);
+    ParallelTrajectoryPlanner planner(threadCount);
+    planner.calcTrajectories(n, p0.data(), pe.data(), amax.data(), vmax.data(),
+                             t0.data(), v0.data(), ve.data(), trajectories.data(), caseNum.data());
+
+    // Save results
+    std::FILE* out = std::fopen(outputPath.c_str(), "w");
+    if (!out) {
+        std::cerr << "Failed to open " << outputPath << std::endl;
+        return 1;
+    }
+    std::fprintf(out, "index,p0,pe,v0,ve,amax,vmax,t0,case,duration,dt0,dt1,dt2\n");
+    std::size_t infeasible = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& s = sets[i];
+        const ConstantAccTrajectory& trajectory = trajectories[i];
+        // accelerate, coast, decelerate; case 0 has no coast segment
+        double dt[3] = {0.0, 0.0, 0.0};
+        if (caseNum[i] == 0) {
+            dt[0] = trajectory.dt[0];
+            dt[2] = trajectory.dt[1];
+        } else if (caseNum[i] == 1) {
+            dt[0] = trajectory.dt[0];
+            dt[1] = trajectory.dt[1];
+            dt[2] = trajectory.dt[2];
+        } else {
+            ++infeasible;
+        }
+        std::fprintf(out, "%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%d,%.17g,%.17g,%.17g,%.17g\n",
+                     i, s.p0, s.pe, s.v0, s.ve, s.amax, s.vmax, s.t0,
+                     caseNum[i], caseNum[i] < 0 ? -1.0 : trajectory.duration, dt[0], dt[1], dt[2]);
+    }
+    if (std::fclose(out) != 0) {
+        std::cerr << "Failed to write " << outputPath << std::endl;
+        return 1;
+    }
+
+    std::cout << "Planned " << sets.size() << " moves (" << infeasible << " infeasible) into "
+              << outputPath << std::endl;
+
+    // Infeasible moves have no segments and hold their start state
+    if (!envelopePath.empty()) {
+        if (!writeEnvelopeFile(envelopePath, trajectories.data(), n, bucketCount)) {
+            std::cerr << "Failed to write " << envelopePath << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote envelopes of " << n << " moves (" << bucketCount << " buckets each) into "
+                  << envelopePath << std::endl;
+    }
+    return 0;
+}
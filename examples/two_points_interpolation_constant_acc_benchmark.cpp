@@ -0,0 +1,609 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "../two_points_interpolation_binary_io.hpp"
+#include "../two_points_interpolation_constant_acc.hpp"
+#include "../two_points_interpolation_constant_acc_batch.hpp"
+#include "../two_points_interpolation_constant_acc_cache.hpp"
+#include "../two_points_interpolation_constant_acc_parallel.hpp"
+#include "../two_points_interpolation_constant_acc_publisher.hpp"
+#include "../two_points_interpolation_constant_acc_store.hpp"
+#include "../two_points_interpolation_constant_acc_waypoints.hpp"
+#include "constraints_sweep.hpp"
+
+namespace {
+
+const std::size_t poolSize = 1024;
+
+// Profiles from the sweep whose solution has segmentCount segments
+// (2: case 0, 3: case 1) and no negative phase.
+std::vector<ConstraintSet> makePool(const std::size_t segmentCount, const std::uint64_t seed = 1) {
+    ConstraintSweep sweep(seed);
+    std::vector<ConstraintSet> pool;
+    while (pool.size() < poolSize) {
+        const ConstraintSet c = sweep.next();
+        TwoPointInterpolation tpi;
+        if (tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve) < 0) {
+            continue;
+        }
+        const ConstantAccTrajectory& trajectory = tpi.trajectory();
+        bool valid = trajectory.segmentCount == segmentCount;
+        for (std::size_t i = 0; i < trajectory.segmentCount; ++i) {
+            valid = valid && trajectory.dt[i] >= 0;
+        }
+        if (valid) {
+            pool.push_back(c);
+        }
+    }
+    return pool;
+}
+
+const std::vector<ConstraintSet>& case0Pool() {
+    static const std::vector<ConstraintSet> pool = makePool(2);
+    return pool;
+}
+
+const std::vector<ConstraintSet>& case1Pool() {
+    static const std::vector<ConstraintSet> pool = makePool(3);
+    return pool;
+}
+
+// Per-call latency percentiles, reported as counters in nanoseconds.
+void reportLatency(benchmark::State& state, std::vector<double>& samples) {
+    if (samples.empty()) {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto percentile = [&samples](const double q) {
+        return samples[static_cast<std::size_t>(q * static_cast<double>(samples.size() - 1))];
+    };
+    state.counters["p50_ns"] = percentile(0.50);
+    state.counters["p99_ns"] = percentile(0.99);
+    state.counters["max_ns"] = samples.back();
+}
+
+template <class Interpolation>
+void calcTrajectoryLoop(benchmark::State& state, const std::vector<ConstraintSet>& pool) {
+    Interpolation tpi;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const ConstraintSet& c = pool[i++ % pool.size()];
+        benchmark::DoNotOptimize(tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void BM_CalcTrajectoryCase0(benchmark::State& state) {
+    calcTrajectoryLoop<TwoPointInterpolation>(state, case0Pool());
+}
+BENCHMARK(BM_CalcTrajectoryCase0);
+
+void BM_CalcTrajectoryCase1(benchmark::State& state) {
+    calcTrajectoryLoop<TwoPointInterpolation>(state, case1Pool());
+}
+BENCHMARK(BM_CalcTrajectoryCase1);
+
+// TwoAngleInterpolation::init normalizes p0, pe and dp before solving.
+void BM_AngleCalcTrajectoryCase0(benchmark::State& state) {
+    calcTrajectoryLoop<TwoAngleInterpolation>(state, case0Pool());
+}
+BENCHMARK(BM_AngleCalcTrajectoryCase0);
+
+void BM_CalcTrajectoryLatency(benchmark::State& state) {
+    const std::vector<ConstraintSet>& pool = state.range(0) == 0 ? case0Pool() : case1Pool();
+    TwoPointInterpolation tpi;
+    std::vector<double> samples;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const ConstraintSet& c = pool[i++ % pool.size()];
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve));
+        const auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    reportLatency(state, samples);
+}
+BENCHMARK(BM_CalcTrajectoryLatency)->Arg(0)->Arg(1);
+
+// Duration only, as used as a cost heuristic; compare with BM_CalcTrajectoryCase1.
+void BM_MinimumDuration(benchmark::State& state) {
+    const std::vector<ConstraintSet>& pool = state.range(0) == 0 ? case0Pool() : case1Pool();
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const ConstraintSet& c = pool[i++ % pool.size()];
+        benchmark::DoNotOptimize(minimumDuration(c.p0, c.pe, c.amax, c.vmax, c.v0, c.ve));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MinimumDuration)->Arg(0)->Arg(1);
+
+// Query position: 0 before t0, 1..3 inside segment 0..2, 4 after the end.
+double queryTime(const ConstantAccTrajectory& trajectory, const int position) {
+    if (position == 0) {
+        return trajectory.t0 - 1.0;
+    }
+    if (position > static_cast<int>(trajectory.segmentCount)) {
+        return trajectory.t0 + trajectory.duration + 1.0;
+    }
+    const std::size_t i = static_cast<std::size_t>(position - 1);
+    return trajectory.t0 + 0.5 * (trajectory.segmentStart[i] + trajectory.segmentStart[i + 1]);
+}
+
+void BM_GetState(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const double t = queryTime(tpi.trajectory(), static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.getState(t));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetState)->DenseRange(0, 4);
+
+void BM_GetPointVector(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const double t = queryTime(tpi.trajectory(), 2);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.getPoint(t));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetPointVector);
+
+// Inverse queries for positions/velocities reached inside segment 0..2.
+void BM_TimeAtPosition(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const double p = tpi.getState(queryTime(tpi.trajectory(), static_cast<int>(state.range(0)))).pos;
+    double t = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.timeAtPosition(p, t));
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimeAtPosition)->DenseRange(1, 3);
+
+void BM_TimeAtVelocity(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const double v = tpi.getState(queryTime(tpi.trajectory(), 3)).vel;
+    double t = 0.0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.timeAtVelocity(v, t));
+        benchmark::DoNotOptimize(t);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TimeAtVelocity);
+
+// Compact message round trip of a case 1 profile with its constraints.
+void BM_CompactEncodeDecode(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation sender;
+    sender.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    TwoPointInterpolation receiver;
+    unsigned char message[compactTrajectoryMaxSize];
+    std::size_t size = 0;
+    for (auto _ : state) {
+        size = encodeCompactTrajectory(sender, message, sizeof(message));
+        benchmark::DoNotOptimize(decodeCompactTrajectory(message, size, receiver));
+    }
+    state.counters["bytes"] = static_cast<double>(size);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CompactEncodeDecode);
+
+void BM_PositionBounds(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.positionBounds(c.t0, c.t0 + te));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PositionBounds);
+
+// Plot data for one profile: state.range(0) 0 samples it densely and scans the
+// samples for the plot ranges as the example used to, 1 takes a 1024-bucket
+// min/max envelope from the segments instead.
+void BM_PlotData(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = 100000;
+    const std::size_t buckets = 1024;
+    const double dt = te / static_cast<double>(n);
+    std::vector<double> time(n + 1), pos(n + 1), vel(n + 1), acc(n + 1);
+    std::vector<double> envelope(6 * buckets);
+    double* e = envelope.data();
+    for (auto _ : state) {
+        if (state.range(0) == 0) {
+            const std::size_t count = tpi.sampleRange(c.t0, c.t0 + te, dt, time.data(), pos.data(), vel.data(), acc.data());
+            benchmark::DoNotOptimize(*std::min_element(pos.begin(), pos.begin() + count));
+            benchmark::DoNotOptimize(*std::max_element(pos.begin(), pos.begin() + count));
+            benchmark::DoNotOptimize(*std::min_element(vel.begin(), vel.begin() + count));
+            benchmark::DoNotOptimize(*std::max_element(vel.begin(), vel.begin() + count));
+        } else {
+            tpi.sampleEnvelope(c.t0, c.t0 + te, buckets, e, e + buckets, e + 2 * buckets, e + 3 * buckets,
+                               e + 4 * buckets, e + 5 * buckets);
+            benchmark::DoNotOptimize(envelope.data());
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PlotData)->Arg(0)->Arg(1);
+
+// state.range(0): 0 no normalization, 1 normalizeAxis, 2 normalizeAxisFast
+void BM_AngleGetState(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoAngleInterpolation tai;
+    tai.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    tai.setFastNormalization(state.range(0) == 2);
+    const double t = queryTime(tai.trajectory(), 2);
+    const bool normalize = state.range(0) != 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tai.getState(t, normalize));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AngleGetState)->DenseRange(0, 2);
+
+// Normalized grid sampling of a rotary axis; state.range(0) as above.
+void BM_AngleSampleRange(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoAngleInterpolation tai;
+    const double te = tai.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    tai.setFastNormalization(state.range(0) == 2);
+    const bool normalize = state.range(0) != 0;
+    const std::size_t n = 100000;
+    const double dt = te / static_cast<double>(n);
+    std::vector<double> time(n + 1), pos(n + 1), vel(n + 1), acc(n + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tai.sampleRange(c.t0, c.t0 + te, dt, time.data(), pos.data(), vel.data(), acc.data(),
+                                                 normalize));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_AngleSampleRange)->DenseRange(0, 2);
+
+void BM_GetStateLatency(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    std::vector<double> samples;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const double t = c.t0 + te * static_cast<double>(i++ % 1000) / 1000.0;
+        const auto start = std::chrono::steady_clock::now();
+        benchmark::DoNotOptimize(tpi.getState(t));
+        const auto stop = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+    }
+    reportLatency(state, samples);
+}
+BENCHMARK(BM_GetStateLatency);
+
+// Samples one trajectory on a grid of state.range(0) points, one getState
+// call per sample, as the example's loop does.
+void BM_SampleLoop(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const double dt = te / static_cast<double>(n);
+    std::vector<double> time(n), pos(n), vel(n), acc(n);
+    for (auto _ : state) {
+        for (std::size_t k = 0; k < n; ++k) {
+            const double t = c.t0 + static_cast<double>(k) * dt;
+            const TrajectoryPoint p = tpi.getState(t);
+            time[k] = t;
+            pos[k] = p.pos;
+            vel[k] = p.vel;
+            acc[k] = p.acc;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_SampleLoop)->Arg(1000)->Arg(100000);
+
+void BM_SampleRange(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const double dt = te / static_cast<double>(n);
+    std::vector<double> time(n + 1), pos(n + 1), vel(n + 1), acc(n + 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tpi.sampleRange(c.t0, c.t0 + te, dt, time.data(), pos.data(), vel.data(), acc.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_SampleRange)->Arg(1000)->Arg(100000);
+
+// Same grid as BM_SampleRange, pushed to a sink in stack-held chunks.
+void BM_SampleStream(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const double dt = te / static_cast<double>(n);
+    double sum = 0.0;
+    for (auto _ : state) {
+        tpi.sampleStream(c.t0, c.t0 + te, dt,
+            [&sum](const double*, const double* pos, const double*, const double*, const std::size_t count) {
+                for (std::size_t j = 0; j < count; ++j) {
+                    sum += pos[j];
+                }
+            });
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_SampleStream)->Arg(1000)->Arg(100000);
+
+void BM_CursorStep(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const double dt = te / static_cast<double>(n);
+    std::vector<double> pos(n), vel(n), acc(n);
+    for (auto _ : state) {
+        TrajectoryCursor cursor = tpi.cursor(c.t0);
+        for (std::size_t k = 0; k < n; ++k) {
+            const TrajectoryPoint& p = cursor.step(dt);
+            pos[k] = p.pos;
+            vel[k] = p.vel;
+            acc[k] = p.acc;
+        }
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_CursorStep)->Arg(1000)->Arg(100000);
+
+// Replays a cached grid of state.range(0) samples by index.
+void BM_SampleCacheReplay(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    TrajectorySampleCache cache;
+    cache.build(tpi, c.t0, c.t0 + te, te / static_cast<double>(n));
+    TrajectoryPoint point;
+    for (auto _ : state) {
+        for (std::size_t k = 0; k < cache.size(); ++k) {
+            cache.getPoint(k, point);
+            benchmark::DoNotOptimize(point);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(cache.size()));
+    state.counters["bytes"] = static_cast<double>(cache.memoryUsage());
+}
+BENCHMARK(BM_SampleCacheReplay)->Arg(1000)->Arg(100000);
+
+// Executor side of the planner/executor handoff: copy the latest snapshot
+// and sample it.
+void BM_PublisherLoadGetState(benchmark::State& state) {
+    const ConstraintSet& c = case1Pool().front();
+    TwoPointInterpolation tpi;
+    const double te = tpi.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    TrajectoryPublisher publisher;
+    publisher.publish(tpi);
+    ConstantAccTrajectory snapshot{};
+    std::size_t i = 0;
+    for (auto _ : state) {
+        if (publisher.load(snapshot)) {
+            benchmark::DoNotOptimize(snapshot.getState(c.t0 + te * static_cast<double>(i++ % 1000) / 1000.0));
+        }
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PublisherLoadGetState);
+
+template <class Scalar>
+void fillBatch(BasicTwoPointInterpolationBatch<Scalar>& batch, const std::vector<ConstraintSet>& pool, const std::size_t n) {
+    batch.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = pool[i % pool.size()];
+        batch.setAxis(i, static_cast<Scalar>(c.p0), static_cast<Scalar>(c.pe),
+                      static_cast<Scalar>(c.amax), static_cast<Scalar>(c.vmax),
+                      static_cast<Scalar>(c.t0), static_cast<Scalar>(c.v0), static_cast<Scalar>(c.ve));
+    }
+}
+
+template <class Scalar>
+void BM_BatchCalcTrajectory(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    BasicTwoPointInterpolationBatch<Scalar> batch;
+    fillBatch(batch, case1Pool(), n);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(batch.calcTrajectory());
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK_TEMPLATE(BM_BatchCalcTrajectory, double)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_BatchCalcTrajectory, float)->Arg(1024)->Arg(65536);
+
+template <class Scalar>
+void BM_BatchGetPoints(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    BasicTwoPointInterpolationBatch<Scalar> batch;
+    fillBatch(batch, case1Pool(), n);
+    batch.calcTrajectory();
+    std::vector<Scalar> pos(n), vel(n), acc(n);
+    Scalar t = 0;
+    for (auto _ : state) {
+        batch.getPoints(t, pos.data(), vel.data(), acc.data());
+        benchmark::ClobberMemory();
+        t += Scalar(0.001);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK_TEMPLATE(BM_BatchGetPoints, double)->Arg(1024)->Arg(65536);
+BENCHMARK_TEMPLATE(BM_BatchGetPoints, float)->Arg(1024)->Arg(65536);
+
+// One planning epoch of a TrajectoryStore: reset, plan state.range(0) moves
+// into the reused slots, then sample all of them once.
+void BM_StoreEpoch(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    const std::vector<ConstraintSet>& pool = case1Pool();
+    TrajectoryStore store(n);
+    std::vector<double> pos(n), vel(n), acc(n);
+    for (auto _ : state) {
+        store.reset();
+        for (std::size_t i = 0; i < n; ++i) {
+            const ConstraintSet& c = pool[i % pool.size()];
+            benchmark::DoNotOptimize(store.plan(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve));
+        }
+        store.getPoints(1.0, pos.data(), vel.data(), acc.data());
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_StoreEpoch)->Arg(1024)->Arg(262144);
+
+// Broad-phase swept extent over a 1 s window, analytic per segment; costs
+// about as much as sampling each axis a few times (see BM_BatchGetPoints).
+void BM_BatchPositionBounds(benchmark::State& state) {
+    const std::size_t n = static_cast<std::size_t>(state.range(0));
+    TwoPointInterpolationBatch batch;
+    fillBatch(batch, case1Pool(), n);
+    batch.calcTrajectory();
+    std::vector<double> lo(n), hi(n);
+    double t = 0.0;
+    for (auto _ : state) {
+        batch.positionBounds(t, t + 1.0, lo.data(), hi.data());
+        benchmark::ClobberMemory();
+        t += 0.001;
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_BatchPositionBounds)->Arg(1024)->Arg(65536);
+
+// Accuracy of the float solver against the double reference over the case 1
+// pool: largest duration error relative to the duration, and largest
+// position error relative to the travelled distance, sampled on 100 points per
+// profile. Reported as counters; the timed loop is the float solve.
+void BM_FloatPrecision(benchmark::State& state) {
+    const std::vector<ConstraintSet>& pool = case1Pool();
+    double durationError = 0.0;
+    double positionError = 0.0;
+    for (std::size_t i = 0; i < pool.size(); ++i) {
+        const ConstraintSet& c = pool[i];
+        TwoPointInterpolation reference;
+        TwoPointInterpolationFloat single;
+        const double te = reference.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        const float tf = single.calcTrajectory(static_cast<float>(c.p0), static_cast<float>(c.pe),
+                                               static_cast<float>(c.amax), static_cast<float>(c.vmax),
+                                               static_cast<float>(c.t0), static_cast<float>(c.v0),
+                                               static_cast<float>(c.ve));
+        durationError = std::max(durationError, std::fabs(static_cast<double>(tf) - te) / te);
+        const double distance = std::max(std::fabs(c.pe - c.p0), 1e-9);
+        for (int k = 0; k <= 100; ++k) {
+            const double t = c.t0 + te * k / 100.0;
+            const double pf = single.getState(static_cast<float>(t)).pos;
+            positionError = std::max(positionError, std::fabs(pf - reference.getState(t).pos) / distance);
+        }
+    }
+    TwoPointInterpolationFloat single;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        const ConstraintSet& c = pool[i++ % pool.size()];
+        benchmark::DoNotOptimize(single.calcTrajectory(static_cast<float>(c.p0), static_cast<float>(c.pe),
+                                                       static_cast<float>(c.amax), static_cast<float>(c.vmax),
+                                                       static_cast<float>(c.t0), static_cast<float>(c.v0),
+                                                       static_cast<float>(c.ve)));
+    }
+    state.counters["max_rel_duration_err"] = durationError;
+    state.counters["max_rel_position_err"] = positionError;
+}
+BENCHMARK(BM_FloatPrecision);
+
+// 1M independent moves on state.range(0) threads (0: one per core).
+void BM_ParallelCalcTrajectories(benchmark::State& state) {
+    const std::size_t n = 1 << 20;
+    const std::vector<ConstraintSet>& pool = case1Pool();
+    std::vector<double> p0(n), pe(n), v0(n), ve(n), amax(n), vmax(n), t0(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = pool[i % pool.size()];
+        p0[i] = c.p0;
+        pe[i] = c.pe;
+        v0[i] = c.v0;
+        ve[i] = c.ve;
+        amax[i] = c.amax;
+        vmax[i] = c.vmax;
+        t0[i] = c.t0;
+    }
+    std::vector<ConstantAccTrajectory> out(n);
+    ParallelTrajectoryPlanner planner(static_cast<unsigned>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(planner.calcTrajectories(n, p0.data(), pe.data(), amax.data(), vmax.data(),
+                                                          t0.data(), v0.data(), ve.data(), out.data()));
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_ParallelCalcTrajectories)->Arg(1)->Arg(0)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// A path through state.range(0) + 1 distinct waypoints, queried on a
+// uniform grid by binary search (getState) and by the sequential cursor.
+double makeWaypointPath(WaypointTrajectory& path, const std::size_t legs) {
+    std::vector<double> positions(legs + 1);
+    for (std::size_t i = 0; i <= legs; ++i) {
+        positions[i] = (i % 2 == 0 ? 1.0 : -1.0) * static_cast<double>(i % 7 + 1);
+    }
+    return path.calcTrajectory(positions, 1.0, 2.0);
+}
+
+void BM_WaypointGetState(benchmark::State& state) {
+    WaypointTrajectory path;
+    const double te = makeWaypointPath(path, static_cast<std::size_t>(state.range(0)));
+    const std::size_t n = 10000;
+    double sum = 0.0;
+    for (auto _ : state) {
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += path.getState(te * static_cast<double>(k) / n).pos;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_WaypointGetState)->Arg(10)->Arg(1000);
+
+void BM_WaypointCursor(benchmark::State& state) {
+    WaypointTrajectory path;
+    const double te = makeWaypointPath(path, static_cast<std::size_t>(state.range(0)));
+    const std::size_t n = 10000;
+    double sum = 0.0;
+    for (auto _ : state) {
+        WaypointTrajectory::Cursor cursor = path.cursor();
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += cursor.getState(te * static_cast<double>(k) / n).pos;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(n));
+}
+BENCHMARK(BM_WaypointCursor)->Arg(10)->Arg(1000);
+
+} // namespace
+
+BENCHMARK_MAIN();
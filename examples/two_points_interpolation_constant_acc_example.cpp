@@ -5,26 +5,26 @@
 #include <iomanip>
 #include <cmath>
 #include <cstdlib>
-#include <algorithm> 
 
 #include <yaml-cpp/yaml.h>
 
 #include "../two_points_interpolation_constant_acc.hpp"
+#include "../two_points_interpolation_binary_io.hpp"
 
 // Function to generate a Gnuplot script
-void generateGnuplotScript(const std::vector<double>& v1, const std::vector<double>& v2,
-                          const std::vector<double>& v3, 
+void generateGnuplotScript(const TrajectoryBounds& r1, const TrajectoryBounds& r2,
+                          const TrajectoryBounds& r3,
                           const std::string& dataFilePath, const std::string& scriptFilePath) {
     std::ofstream scriptFile(scriptFilePath);
     scriptFile << "set terminal png\n";
     scriptFile << "set output 'graph.png'\n";
     scriptFile << "set grid\n";
     scriptFile << "set multiplot layout 3,1\n";
-    scriptFile << "set yrange [" << *std::min_element(v1.begin(), v1.end())*1.1 << ":"  << *std::max_element(v1.begin(), v1.end())*1.1 << "]\n";
+    scriptFile << "set yrange [" << r1.lo*1.1 << ":"  << r1.hi*1.1 << "]\n";
     scriptFile << "plot '" << dataFilePath << "' using 1:2 with lines title 'acc[m/s^2]'\n";
-    scriptFile << "set yrange [" << *std::min_element(v2.begin(), v2.end())*1.1 << ":"  << *std::max_element(v2.begin(), v2.end())*1.1 << "]\n";
+    scriptFile << "set yrange [" << r2.lo*1.1 << ":"  << r2.hi*1.1 << "]\n";
     scriptFile << "plot '" << dataFilePath << "' using 1:3 with lines title 'vel[m/s]'\n";
-    scriptFile << "set yrange [" << *std::min_element(v3.begin(), v3.end())*1.1 << ":"  << *std::max_element(v3.begin(), v3.end())*1.1 << "]\n";
+    scriptFile << "set yrange [" << r3.lo*1.1 << ":"  << r3.hi*1.1 << "]\n";
     scriptFile << "plot '" << dataFilePath << "' using 1:4 with lines title 'pos[m]'\n";
     scriptFile << "unset multiplot\n";
     scriptFile.close();
@@ -47,7 +47,8 @@ void saveVectorDataToFile(const std::vector<double>& v1, const std::vector<doubl
 // Function to load constraints from a YAML file
 bool loadConstraintsFromYaml(const std::string& filePath, double& p0, double& pe,
                              double& v0, double& ve, double& amax, double& vmax,
-                             double& t0, double& dt, bool& verbose, bool& normalize_angle) {
+                             double& t0, double& dt, bool& verbose, bool& normalize_angle,
+                             bool& plot) {
     try {
         YAML::Node config = YAML::LoadFile(filePath);
 
@@ -61,6 +62,7 @@ bool loadConstraintsFromYaml(const std::string& filePath, double& p0, double& pe
         dt = config["dt"].as<double>();
         verbose = config["verbose"].as<bool>();
         normalize_angle = config["normalize_angle"].as<bool>();
+        plot = config["plot"] ? config["plot"].as<bool>() : true;
 
         return true;
     } catch (const YAML::Exception& e) {
@@ -84,8 +86,8 @@ int main(int argc, char* argv[]) {
 
     // Load constraints from YAML
     double p0, pe, v0, ve, amax, vmax, t0, dt;
-    bool verbose, normalize_angle;
-    if (!loadConstraintsFromYaml(filename, p0, pe, v0, ve, amax, vmax, t0, dt, verbose, normalize_angle)) {
+    bool verbose, normalize_angle, plot;
+    if (!loadConstraintsFromYaml(filename, p0, pe, v0, ve, amax, vmax, t0, dt, verbose, normalize_angle, plot)) {
         return 1;
     }
 
@@ -94,27 +96,49 @@ int main(int argc, char* argv[]) {
     const double te = tpi.calcTrajectory(p0, pe, amax, vmax, t0, v0, ve);
 
     // Simulation condition
-    std::vector<double> tref;
-    std::vector<double> pos;
-    std::vector<double> vel;
-    std::vector<double> acc;
+    const std::size_t sampleCount = TwoPointInterpolation::sampleCount(t0, t0 + te, dt);
+    std::vector<double> tref(sampleCount);
+    std::vector<double> pos(sampleCount);
+    std::vector<double> vel(sampleCount);
+    std::vector<double> acc(sampleCount);
 
     // Calculate pos, vel, and acc
-    for (double t = t0; t < t0 + te; t += dt) {
-        std::vector<double> res = tpi.getPoint(t, normalize_angle);
-        tref.push_back(t);
-        pos.push_back(res[0]);
-        vel.push_back(res[1]);
-        acc.push_back(res[2]);
+    tpi.sampleRange(t0, t0 + te, dt, tref.data(), pos.data(), vel.data(), acc.data(), normalize_angle);
+
+    // Save the segments and the exact samples for other tools (see two_points_interpolation_binary_io.hpp)
+    if (!writeTrajectoryFile("data.bin", tpi.trajectory(), tref.data(), pos.data(), vel.data(), acc.data(),
+                             sampleCount, t0, dt)) {
+        std::cerr << "Failed to write data.bin" << std::endl;
+    }
+
+    // Save the min/max envelope that a viewer draws the profile from
+    if (!writeEnvelopeFile("envelope.bin", &tpi.trajectory(), 1, 1024)) {
+        std::cerr << "Failed to write envelope.bin" << std::endl;
+    }
+
+    if (!plot) {
+        return 0;
     }
 
     // Save data to a file
     std::string dataFilePath = "data.txt";
     saveVectorDataToFile(tref, acc, vel, pos, dataFilePath);
 
+    // Plot ranges from the segments; wrapped angles span the whole circle
+    // as soon as the motion crosses +-pi
+    const TrajectoryBounds accRange = tpi.accelerationBounds(t0, t0 + te);
+    const TrajectoryBounds velRange = tpi.velocityBounds(t0, t0 + te);
+    TrajectoryBounds posRange = tpi.positionBounds(t0, t0 + te);
+    if (normalize_angle) {
+        const double lo = normalizeAxis(posRange.lo);
+        const double hi = lo + (posRange.hi - posRange.lo);
+        posRange.lo = hi <= M_PI ? lo : -M_PI;
+        posRange.hi = hi <= M_PI ? hi : M_PI;
+    }
+
     // Generate Gnuplot script
     std::string scriptFilePath = "script.gnu";
-    generateGnuplotScript(acc, vel, pos, dataFilePath, scriptFilePath);
+    generateGnuplotScript(accRange, velRange, posRange, dataFilePath, scriptFilePath);
 
     // Execute Gnuplot script
     std::string command = "gnuplot " + scriptFilePath;
@@ -0,0 +1,97 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../two_points_interpolation_constant_acc_batch.hpp"
+#include "../two_points_interpolation_constant_acc_cuda.cuh"
+
+// Solves and samples a large set of random moves on the GPU and checks the
+// result against the CPU batch solver.
+//
+//   ./TwoPointsInterpolationCuda [moves] [samples]
+
+// Device array freed on every return path.
+struct DeviceBuffer {
+    double* data;
+
+    DeviceBuffer() : data(nullptr) {}
+    ~DeviceBuffer() {
+        cudaFree(data);
+    }
+
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+
+    bool allocate(const std::size_t count) {
+        return cudaMalloc(&data, count * sizeof(double)) == cudaSuccess;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    const std::size_t n = argc > 1 ? static_cast<std::size_t>(std::atol(argv[1])) : 1000000;
+    const int sampleCount = argc > 2 ? std::atoi(argv[2]) : 100;
+    if (sampleCount < 1) {
+        std::fprintf(stderr, "The sample count must be at least 1\n");
+        return 1;
+    }
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> pos(-10.0, 10.0);
+    std::uniform_real_distribution<double> limit(0.5, 5.0);
+    std::vector<double> p0(n), pe(n), amax(n), vmax(n);
+    TwoPointInterpolationBatch cpu(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        p0[i] = pos(gen);
+        pe[i] = pos(gen);
+        amax[i] = limit(gen);
+        vmax[i] = limit(gen);
+        cpu.setAxis(i, p0[i], pe[i], amax[i], vmax[i]);
+    }
+
+    TwoPointInterpolationCudaBatch gpu(n);
+    if (gpu.size() != n) {
+        std::fprintf(stderr, "CUDA error: %s\n", cudaGetErrorString(gpu.lastError()));
+        return 1;
+    }
+    DeviceBuffer dPos, dVel, dAcc;
+    if (!dPos.allocate(n) || !dVel.allocate(n) || !dAcc.allocate(n)) {
+        std::fprintf(stderr, "Failed to allocate the sample buffers\n");
+        return 1;
+    }
+
+    // Upload once, then solve and sample without leaving the device.
+    if (!gpu.upload(p0.data(), pe.data(), amax.data(), vmax.data()) || !gpu.calcTrajectory()) {
+        std::fprintf(stderr, "CUDA error: %s\n", cudaGetErrorString(gpu.lastError()));
+        return 1;
+    }
+    const double tEnd = 20.0;
+    for (int k = 0; k < sampleCount; ++k) {
+        if (!gpu.getPoints(tEnd * k / sampleCount, dPos.data, dVel.data, dAcc.data)) {
+            std::fprintf(stderr, "CUDA error: %s\n", cudaGetErrorString(gpu.lastError()));
+            return 1;
+        }
+    }
+
+    // Compare the last samples and the durations with the CPU.
+    std::vector<double> duration(n), gpuPos(n), cpuPos(n), cpuVel(n), cpuAcc(n);
+    std::vector<int> caseNum(n);
+    if (!gpu.download(duration.data(), caseNum.data())
+        || cudaMemcpy(gpuPos.data(), dPos.data, n * sizeof(double), cudaMemcpyDeviceToHost) != cudaSuccess) {
+        std::fprintf(stderr, "CUDA error: %s\n", cudaGetErrorString(gpu.lastError()));
+        return 1;
+    }
+    cpu.calcTrajectory();
+    cpu.getPoints(tEnd * (sampleCount - 1) / sampleCount, cpuPos.data(), cpuVel.data(), cpuAcc.data());
+
+    std::size_t mismatches = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (caseNum[i] != cpu.caseNum(i) || duration[i] != cpu.duration(i) || gpuPos[i] != cpuPos[i]) {
+            ++mismatches;
+        }
+    }
+    std::printf("Solved %zu moves and sampled them %d times on the GPU, %zu differ from the CPU\n",
+                n, sampleCount, mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,36 @@
+// Compiled as C++11 by CMake to keep the headers usable without C++17
+// (two_points_interpolation_constant_acc_constexpr.hpp needs C++17 and is
+// left out).
+#include <type_traits>
+
+#include "../two_points_interpolation_binary_io.hpp"
+#include "../two_points_interpolation_constant_acc.hpp"
+#include "../two_points_interpolation_constant_acc_batch.hpp"
+#include "../two_points_interpolation_constant_acc_cache.hpp"
+#include "../two_points_interpolation_constant_acc_parallel.hpp"
+#include "../two_points_interpolation_constant_acc_publisher.hpp"
+#include "../two_points_interpolation_constant_acc_stats.hpp"
+#include "../two_points_interpolation_constant_acc_store.hpp"
+#include "../two_points_interpolation_constant_acc_waypoints.hpp"
+#include "../two_points_interpolation_constant_jerk.hpp"
+
+// Integer arguments must keep converting to the double overloads rather
+// than instantiating the floating-point templates.
+static_assert(std::is_same<decltype(pInteg(0, 0, 1, 1)), double>::value, "pInteg(int...) must be double");
+static_assert(std::is_same<decltype(vInteg(0, 1, 1)), double>::value, "vInteg(int...) must be double");
+static_assert(std::is_same<decltype(normalizeAxis(4)), double>::value, "normalizeAxis(int) must be double");
+static_assert(std::is_same<decltype(normalizeAxis(4.0f)), float>::value, "normalizeAxis(float) must be float");
+
+// Instantiates the main templates and the fast normalization.
+double twoPointsInterpolationCxx11Check() {
+    TwoPointInterpolation tpi;
+    const double duration = tpi.calcTrajectory(0.0, 1.0, 1.0, 2.0);
+    TwoPointInterpolationFloat tpf;
+    tpf.calcTrajectory(0.0f, 1.0f, 1.0f, 2.0f);
+    BasicTrajectoryCursor<float> cursor = tpf.cursor(0.0f);
+    TwoPointInterpolationBatch batch(1);
+    batch.setAxis(0, 0.0, 1.0, 1.0, 2.0);
+    batch.calcTrajectory();
+    return duration + tpi.getState(0.5).pos + tpf.getState(0.5f).pos + cursor.step(0.5f).pos + batch.getState(0, 0.5).pos
+        + normalizeAxisFast(duration);
+}
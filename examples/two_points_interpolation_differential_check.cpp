@@ -0,0 +1,1365 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../two_points_interpolation_binary_io.hpp"
+#include "../two_points_interpolation_constant_acc.hpp"
+#include "../two_points_interpolation_constant_acc_batch.hpp"
+#include "../two_points_interpolation_constant_acc_parallel.hpp"
+#include "../two_points_interpolation_constant_acc_publisher.hpp"
+#include "../two_points_interpolation_constant_acc_store.hpp"
+#include "../two_points_interpolation_constant_acc_waypoints.hpp"
+#include "../two_points_interpolation_constant_jerk.hpp"
+#include "constraints_sweep.hpp"
+
+// Randomized differential check of every fast path against the original
+// vector-based algorithm, plus a throughput gate.
+//
+//   ./TwoPointsInterpolationDifferentialCheck [baselines.txt] [cases] [seed]
+//
+// The solver, getState(), minimumDuration() and isFeasible(), the batch
+// solver (double and float), the cursor (double and float), sampleRange(),
+// sampleTimes(), sampleStream(), sampleEnvelope(), fast angle normalization,
+// the parallel planner, the store, the publisher, trajectory files and the
+// compact codec are compared with the reference on seeded sweeps and
+// on known edge cases (dp == 0, v0 or ve beyond vmax, peak velocity exactly
+// vmax, extreme scales). Profiles are also checked for continuity at their
+// segment boundaries, replan() against a fresh solve and waypoint paths
+// against their legs solved on their own. The jerk-limited profile of each
+// move is checked for continuity, its end state and its limits, and
+// synchronized groups of moves for a common arrival within every axis'
+// limits. timeAtPosition() and timeAtVelocity() must find the state at each
+// probe time again within the profile. Then the hot paths are timed and
+// compared with the floors in the baselines file ("-" skips this); a missing
+// file is created from the measured values. Exits with 1 if any check fails
+// or any throughput is below throughputSlack (0.5) times its floor, i.e. more
+// than twice as slow as when the floors were recorded.
+
+// The original implementation, kept verbatim apart from the verbose output,
+// so its int/size_t loop comparisons stay too; their warnings are silenced
+// here rather than edited away.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#endif
+
+namespace reference {
+
+inline double vInteg(const double v0, const double a, const double dt) {
+    return v0 + a * dt;
+}
+
+inline double pInteg(const double p0, const double v0, const double a, const double dt) {
+    return p0 + v0 * dt + 0.5 * a * dt * dt;
+}
+
+inline double normalizeAxis(const double input){
+    double output = fmod(input + M_PI, 2 * M_PI);
+    if (output < 0)
+    {
+        output += 2 * M_PI;
+    }
+    return output - M_PI;
+}
+
+class TwoPointInterpolation {
+private:
+    bool _pointSetted;
+    bool _constraintsSetted;
+    bool _initialStateSetted;
+    bool _trajectoryCalced;
+
+    double _t0;
+    double _p0;
+    double _v0;
+    double _pe;
+    double _ve;
+    double _amax;
+    double _vmax;
+    std::vector<double> _dt;
+    std::vector<double> _a;
+    std::vector<double> _v;
+    std::vector<double> _p;
+    double _aSigned;
+    int _caseNum;
+
+public:
+    TwoPointInterpolation() {
+        _pointSetted = false;
+        _constraintsSetted = false;
+        _initialStateSetted = false;
+        _trajectoryCalced = false;
+    }
+
+    void setInitial(const double t0, const double p0, const double v0 = 0) {
+        _t0 = t0;
+        _p0 = p0;
+        _v0 = v0;
+        _initialStateSetted = true;
+    }
+
+    void setPoint(const double pe, const double ve = 0) {
+        _pe = pe;
+        _ve = ve;
+        _pointSetted = true;
+    }
+
+    void setConstraints(const double amax, const double vmax) {
+        _amax = amax;
+        _vmax = vmax;
+        _constraintsSetted = true;
+    }
+
+    bool isInitialized()
+    {
+        return _pointSetted && _constraintsSetted && _initialStateSetted && _trajectoryCalced;
+    }
+
+    void init(const double p0, const double pe,
+              const double amax, const double vmax,
+              const double t0 = 0, const double v0 = 0,
+              const double ve = 0) {
+        setInitial(t0, p0, v0);
+        setPoint(pe, ve);
+        setConstraints(amax, vmax);
+    }
+
+    double calcTrajectory() {
+        double dp = _pe - _p0;
+        double dv = _ve - _v0;
+
+        _dt.clear();
+        _a.clear();
+        _v.clear();
+        _p.clear();
+
+        _v.push_back(_v0);
+        _p.push_back(_p0);
+
+        _aSigned = _amax * dp / std::fabs(dp);
+        double b = _v0 / _aSigned;
+        double c = (-dv * (_ve + _v0) * 0.5 / _aSigned - dp) / _aSigned;
+        if (b * b - c > 0) {
+            double dt01 = -b + std::sqrt(b * b - c);
+            double v1 = vInteg(_v0, _aSigned, dt01);
+            if (std::fabs(v1) < _vmax) { // not reach the vmax
+                _caseNum = 0;
+                double p1 = pInteg(_p0, _v0, _aSigned, dt01);
+                double dt1e = dt01 - dv / _aSigned;
+                _dt.push_back(dt01);
+                _dt.push_back(dt1e);
+                _a.push_back(_aSigned);
+                _a.push_back(-_aSigned);
+                _v.push_back(v1);
+                _p.push_back(p1);
+            } else {
+                _caseNum = 1;
+                v1 = _vmax * dp / std::fabs(dp);
+                dt01 = (v1 - _v0) / _aSigned;
+                double p1 = pInteg(_p0, _v0, _aSigned, dt01);
+                _dt.push_back(dt01);
+                _a.push_back(_aSigned);
+                _v.push_back(v1);
+                _p.push_back(p1);
+                double v2 = v1;
+                double dt2e = (_ve - v2) / -_aSigned;
+                double dp2e = pInteg(0, v2, -_aSigned, dt2e);
+                double dt12 = (_pe - p1 - dp2e) / v1;
+                double p2 = _pe - dp2e;
+                _dt.push_back(dt12);
+                _dt.push_back(dt2e);
+                _a.push_back(0.0);
+                _a.push_back(-_aSigned);
+                _v.push_back(v2);
+                _p.push_back(p2);
+            }
+        } else {
+            return -1;
+        }
+
+        _trajectoryCalced = true;
+
+        double totalDt = 0;
+        for (double t : _dt) {
+            totalDt += t;
+        }
+
+        return totalDt;
+    }
+
+    double calcTrajectory(const double p0, const double pe,
+                          const double amax, const double vmax,
+                          const double t0 = 0, const double v0 = 0,
+                          const double ve = 0) {
+        init(p0, pe, amax, vmax, t0, v0, ve);
+        return calcTrajectory();
+    }
+
+    int caseNum() const {
+        return _caseNum;
+    }
+
+    std::vector<double> getPoint(const double t) const {
+        double a = 0;
+        double v = 0;
+        double pos = 0;
+
+        double tau = t - _t0;
+
+        if (tau < 0) {
+            a = 0.0;
+            v = _v0;
+            pos = _p0;
+        } else if (tau >= sum(_dt, _dt.size() + 1)) {
+            a = 0.0;
+            v = _ve;
+            pos = _pe;
+        } else {
+            double a_in = 0.0;
+            double v_in = 0.0;
+            double p_in = 0.0;
+            double t_in = tau;
+            for (int i = 0; i < _dt.size(); i++) {
+                double dt_i = sum(_dt, i + 1);
+                if (tau <= dt_i) {
+                    t_in = tau - sum(_dt, i);
+                    a_in = _a[i];
+                    v_in = _v[i];
+                    p_in = _p[i];
+                    break;
+                }
+            }
+
+            a = a_in;
+            v = vInteg(v_in, a_in, t_in);
+            pos = pInteg(p_in, v_in, a_in, t_in);
+        }
+
+        std::vector<double> result = {pos, v, a};
+        return result;
+    }
+
+private:
+    double sum(const std::vector<double>& values, const int count) const {
+        double total = 0.0;
+        for (int i = 0; i < count && i < values.size(); ++i) {
+            total += values[i];
+        }
+        return total;
+    }
+};
+
+class TwoAngleInterpolation : public TwoPointInterpolation {
+public:
+    void init(const double p0, const double pe,
+              const double amax, const double vmax,
+              const double t0 = 0, const double v0 = 0,
+              const double ve = 0) {
+        const double p0n = normalizeAxis(p0);
+        const double pen = normalizeAxis(pe);
+        const double dp = normalizeAxis(pen - p0n);
+
+        setInitial(t0, p0n, v0);
+        setPoint(p0n+dp, ve);
+        setConstraints(amax, vmax);
+    }
+
+    double calcTrajectory(const double p0, const double pe,
+                          const double amax, const double vmax,
+                          const double t0 = 0, const double v0 = 0,
+                          const double ve = 0) {
+        init(p0, pe, amax, vmax, t0, v0, ve);
+        return TwoPointInterpolation::calcTrajectory();
+    }
+
+    std::vector<double> getPoint(const double t, const bool normalize = true) const {
+        std::vector<double> result = TwoPointInterpolation::getPoint(t);
+        if (normalize)
+        {
+            result[0] = normalizeAxis(result[0]);
+        }
+        return result;
+    }
+};
+
+} // namespace reference
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+
+// Relative tolerances, scaled by the position or velocity range of a profile.
+const double continuityTolerance = 1e-10;
+const double cursorTolerance = 1e-9;
+const double cursorFloatTolerance = 1e-4;
+const double floatTolerance = 1e-3;
+
+// Fraction of its floor a throughput may drop to before the gate fails
+// (see the top of the file); generous, since timings on a shared machine
+// easily vary by a third.
+const double throughputSlack = 0.5;
+
+// Moves per batch, parallel and store round.
+const std::size_t chunkSize = 257;
+
+bool same(const double x, const double y) {
+    return x == y || (std::isnan(x) && std::isnan(y));
+}
+
+bool sameTrajectory(const ConstantAccTrajectory& x, const ConstantAccTrajectory& y) {
+    bool ok = same(x.t0, y.t0) && same(x.duration, y.duration) && x.segmentCount == y.segmentCount
+        && same(x.p0, y.p0) && same(x.v0, y.v0) && same(x.pe, y.pe) && same(x.ve, y.ve);
+    for (std::size_t i = 0; ok && i < x.segmentCount; ++i) {
+        ok = same(x.dt[i], y.dt[i]) && same(x.a[i], y.a[i]) && same(x.v[i], y.v[i])
+            && same(x.p[i], y.p[i]) && same(x.segmentStart[i + 1], y.segmentStart[i + 1]);
+    }
+    return ok;
+}
+
+// Tally of one check. The first few failures are printed with the move that
+// caused them.
+struct Check {
+    const char* name;
+    std::size_t compared = 0;
+    std::size_t failures = 0;
+    double maxError = 0;
+
+    void expect(const bool ok, const ConstraintSet& c, const double t, const double error = 0) {
+        ++compared;
+        if (error > maxError) {
+            maxError = error;
+        }
+        if (ok) {
+            return;
+        }
+        if (++failures <= 5) {
+            std::fprintf(stderr, "%s: mismatch for p0=%.17g pe=%.17g v0=%.17g ve=%.17g amax=%.17g vmax=%.17g t0=%.17g at t=%.17g\n",
+                         name, c.p0, c.pe, c.v0, c.ve, c.amax, c.vmax, c.t0, t);
+        }
+    }
+
+    void expectState(const std::vector<double>& expected, const double pos, const double vel, const double acc,
+                     const ConstraintSet& c, const double t) {
+        expect(same(expected[0], pos) && same(expected[1], vel) && same(expected[2], acc), c, t);
+    }
+
+    // Relative error of pos and vel against expected, which must stay within tolerance.
+    void expectClose(const std::vector<double>& expected, const double pos, const double vel,
+                     const double positionScale, const double velocityScale, const double tolerance,
+                     const ConstraintSet& c, const double t) {
+        const double error = std::max(std::fabs(pos - expected[0]) / positionScale,
+                                      std::fabs(vel - expected[1]) / velocityScale);
+        expect(error <= tolerance, c, t, error);
+    }
+};
+
+// One move, with what the reference makes of it.
+struct Case {
+    ConstraintSet c;
+    double duration;       // reference calcTrajectory() result
+    bool solved;           // the reference found a profile (possibly a degenerate one)
+    bool feasible;         // solved with a finite duration >= 0
+    bool monotone;         // feasible without a negative phase
+    std::vector<double> times; // ascending probe times
+    double positionScale;
+    double velocityScale;
+};
+
+ConstraintSet makeConstraints(const double p0, const double pe, const double v0, const double ve,
+                              const double amax, const double vmax, const double t0 = 0) {
+    ConstraintSet c = {p0, pe, v0, ve, amax, vmax, t0, 0.001};
+    return c;
+}
+
+// Moves the original algorithm is known to handle specially or badly.
+std::vector<ConstraintSet> edgeCases() {
+    std::vector<ConstraintSet> cases;
+    cases.push_back(makeConstraints(1, 1, 0, 0, 1, 2));           // dp == 0: NaN acceleration, infeasible
+    cases.push_back(makeConstraints(1, 1, 1, -1, 1, 2));          // dp == 0 while moving
+    cases.push_back(makeConstraints(0, 0, 0, 0, 0, 0));
+    cases.push_back(makeConstraints(0, 10, 5, 0, 1, 2));          // v0 above vmax: negative first phase
+    cases.push_back(makeConstraints(0, 10, -5, 0, 1, 2));         // |v0| above vmax, moving away
+    cases.push_back(makeConstraints(0, 10, 0, 5, 1, 2));          // ve above vmax
+    cases.push_back(makeConstraints(0, -10, 5, -5, 1, 2));
+    cases.push_back(makeConstraints(0, 10, 2, 0, 1, 2));          // starts at vmax
+    cases.push_back(makeConstraints(0, 4, 0, 0, 1, 2));           // peak velocity exactly vmax
+    cases.push_back(makeConstraints(0, 4, 0, 0, 1, std::nextafter(2.0, 3.0)));
+    cases.push_back(makeConstraints(0, 1e-12, 0, 0, 1, 2));       // tiny move
+    cases.push_back(makeConstraints(-1e9, 1e9, 0, 0, 1, 1e3));    // long coast
+    cases.push_back(makeConstraints(0, 1, 0, 0, 1e-6, 1));        // tiny acceleration
+    cases.push_back(makeConstraints(0, 1, 0, 0, 1e6, 1e6));       // huge acceleration
+    cases.push_back(makeConstraints(0, 1, 0, 0, 0, 1));           // no acceleration
+    cases.push_back(makeConstraints(0, 1, 0, 0, 1, 0));           // no velocity
+    cases.push_back(makeConstraints(0, 10, 0, 0, 1, 2, -1e6));    // far from the time origin
+    cases.push_back(makeConstraints(0, 10, 0, 0, 1, 2, 1e6));
+    cases.push_back(makeConstraints(5, -5, 3, 0, 1, 10));         // overshoot and come back
+    cases.push_back(makeConstraints(3.0, -3.0, 0, 0, 1, 2));      // angles across the wrap
+    cases.push_back(makeConstraints(1000.5, -2000.25, 0.5, -0.5, 2, 3));
+    return cases;
+}
+
+// Sorted probe times: before t0, on and next to every segment boundary,
+// after the end, and random times over the profile.
+std::vector<double> probeTimes(const ConstantAccTrajectory& trajectory, std::mt19937_64& rng) {
+    std::vector<double> times;
+    const double t0 = trajectory.t0;
+    const double span = std::isfinite(trajectory.duration) ? std::fabs(trajectory.duration) : 1.0;
+    times.push_back(t0 - 1.0);
+    for (std::size_t k = 0; k <= trajectory.segmentCount; ++k) {
+        const double tb = t0 + trajectory.segmentStart[k];
+        times.push_back(std::nextafter(tb, -INFINITY));
+        times.push_back(tb);
+        times.push_back(std::nextafter(tb, INFINITY));
+    }
+    times.push_back(t0 + span + 1.0);
+    std::uniform_real_distribution<double> uniform(t0 - 0.1 * span, t0 + 1.1 * span);
+    for (int k = 0; k < 16; ++k) {
+        times.push_back(uniform(rng));
+    }
+    times.erase(std::remove_if(times.begin(), times.end(), [](const double t) { return !std::isfinite(t); }),
+                times.end());
+    std::sort(times.begin(), times.end());
+    return times;
+}
+
+Case makeCase(const ConstraintSet& c, const bool solved, const double duration,
+              const TwoPointInterpolation& planner, std::mt19937_64& rng) {
+    Case result;
+    result.c = c;
+    result.duration = duration;
+    result.solved = solved;
+    result.feasible = solved && std::isfinite(duration) && duration >= 0;
+    const ConstantAccTrajectory& trajectory = planner.trajectory();
+    result.monotone = result.feasible;
+    double pMax = std::max(std::fabs(c.p0), std::fabs(c.pe));
+    double vMax = std::max(std::fabs(c.v0), std::fabs(c.ve));
+    for (std::size_t i = 0; result.feasible && i < trajectory.segmentCount; ++i) {
+        result.monotone = result.monotone && trajectory.dt[i] >= 0;
+        pMax = std::max(pMax, std::fabs(trajectory.p[i]));
+        vMax = std::max(vMax, std::fabs(trajectory.v[i]));
+    }
+    if (result.feasible) {
+        result.times = probeTimes(trajectory, rng);
+    }
+    result.positionScale = 1.0 + pMax + vMax * std::fabs(duration);
+    result.velocityScale = 1.0 + vMax + std::fabs(c.amax) * std::fabs(duration);
+    return result;
+}
+
+// calcTrajectory(), getState() and the angle planner against the reference.
+void checkScalar(const Case& k, const reference::TwoPointInterpolation& ref, const TwoPointInterpolation& planner,
+                 Check& solve, Check& state, Check& angle, Check& fastAngle) {
+    const ConstraintSet& c = k.c;
+    if (!k.feasible) {
+        return;
+    }
+    for (const double t : k.times) {
+        const TrajectoryPoint s = planner.getState(t);
+        state.expectState(ref.getPoint(t), s.pos, s.vel, s.acc, c, t);
+    }
+
+    reference::TwoAngleInterpolation refAngle;
+    TwoAngleInterpolation angleExact;
+    TwoAngleInterpolation angleFast;
+    angleFast.setFastNormalization(true);
+    const double refDuration = refAngle.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    solve.expect(same(refDuration, angleExact.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve)), c, 0);
+    angleFast.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    if (!(refDuration >= 0)) {
+        return;
+    }
+    for (const double t : k.times) {
+        const TrajectoryPoint raw = angleExact.getState(t, false);
+        const TrajectoryPoint wrapped = angleExact.getState(t);
+        angle.expectState(refAngle.getPoint(t, false), raw.pos, raw.vel, raw.acc, c, t);
+        angle.expectState(refAngle.getPoint(t), wrapped.pos, wrapped.vel, wrapped.acc, c, t);
+
+        // the fast reduction may round differently, and may land on the
+        // other side of the +-pi cut
+        const TrajectoryPoint fast = angleFast.getState(t);
+        double error = fast.pos - wrapped.pos;
+        if (std::fabs(error) > M_PI) {
+            error -= std::copysign(2 * M_PI, error);
+        }
+        const double ulps = std::fabs(error) / (std::numeric_limits<double>::epsilon() * std::max(std::fabs(raw.pos), M_PI));
+        fastAngle.expect(ulps <= 4 && same(fast.vel, wrapped.vel) && std::fabs(fast.pos) <= M_PI, c, t, ulps);
+    }
+}
+
+// Boundary continuity of the planned profile: each segment ends where the
+// next one starts, the profile starts at (p0, v0) and ends at (pe, ve), and
+// getState() does not jump across a boundary.
+void checkContinuity(const Case& k, const TwoPointInterpolation& planner, Check& continuity) {
+    if (!k.monotone) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    const ConstantAccTrajectory& tr = planner.trajectory();
+    const auto expectJoin = [&](const double p, const double v, const double pNext, const double vNext, const double t) {
+        const double error = std::max(std::fabs(p - pNext) / k.positionScale, std::fabs(v - vNext) / k.velocityScale);
+        continuity.expect(error <= continuityTolerance, c, t, error);
+    };
+    expectJoin(tr.p[0], tr.v[0], c.p0, c.v0, tr.t0);
+    for (std::size_t i = 0; i < tr.segmentCount; ++i) {
+        const double pEnd = pInteg(tr.p[i], tr.v[i], tr.a[i], tr.dt[i]);
+        const double vEnd = vInteg(tr.v[i], tr.a[i], tr.dt[i]);
+        const bool last = i + 1 == tr.segmentCount;
+        expectJoin(pEnd, vEnd, last ? c.pe : tr.p[i + 1], last ? c.ve : tr.v[i + 1], tr.t0 + tr.segmentStart[i + 1]);
+
+        const double tb = tr.t0 + tr.segmentStart[i + 1];
+        const double tAfter = std::nextafter(tb, INFINITY);
+        const TrajectoryPoint left = planner.getState(tb);
+        const TrajectoryPoint right = planner.getState(tAfter);
+        const double drift = std::fabs(left.vel) * (tAfter - tb) + std::fabs(left.acc) * (tAfter - tb) * (tAfter - tb);
+        const double error = std::max((std::fabs(left.pos - right.pos) - drift) / k.positionScale,
+                                      std::fabs(left.vel - right.vel) / k.velocityScale);
+        continuity.expect(error <= continuityTolerance, c, tb, std::max(error, 0.0));
+    }
+}
+
+// replan() from inside a random segment. Each new target is compared with a
+// fresh solve from the sampled state. When that solve has no negative phase,
+// replan() must give the same profile and a new revision(). Otherwise it
+// must return -1 and keep the old profile and revision. The targets are a
+// shifted end point, and a stop at a tenth of the stopping distance, which
+// needs a negative phase while moving. A target within the tolerance of the
+// current one must leave the profile untouched.
+void checkReplan(const Case& k, const TwoPointInterpolation& planner, std::mt19937_64& rng, Check& replanCheck) {
+    if (!k.monotone || !(k.duration > 0)) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    const ConstantAccTrajectory& tr = planner.trajectory();
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const std::size_t segment = std::min(static_cast<std::size_t>(unit(rng) * tr.segmentCount), tr.segmentCount - 1);
+    const double t = tr.t0 + tr.segmentStart[segment] + tr.dt[segment] * (0.25 + 0.5 * unit(rng));
+    const TrajectoryPoint s = planner.getState(t);
+    const double targets[2][2] = {{c.pe + (c.pe - c.p0) * (unit(rng) - 0.5), c.ve * unit(rng)},
+                                  {s.pos + 0.05 * s.vel * std::fabs(s.vel) / c.amax, 0.0}};
+    for (const auto& target : targets) {
+        TwoPointInterpolation fresh;
+        const double freshDuration = fresh.calcTrajectory(s.pos, target[0], c.amax, c.vmax, t, s.vel, target[1]);
+        bool freshValid = fresh.isInitialized();
+        for (std::size_t i = 0; i < fresh.trajectory().segmentCount; ++i) {
+            freshValid = freshValid && fresh.trajectory().dt[i] >= 0;
+        }
+        TwoPointInterpolation replanned = planner;
+        const double duration = replanned.replan(t, target[0], target[1]);
+        if (freshValid) {
+            replanCheck.expect(same(duration, freshDuration) && sameTrajectory(replanned.trajectory(), fresh.trajectory())
+                               && replanned.revision() != planner.revision(), c, t);
+        } else {
+            replanCheck.expect(duration == -1 && sameTrajectory(replanned.trajectory(), tr)
+                               && replanned.revision() == planner.revision(), c, t);
+        }
+    }
+
+    const double tolerance = 1e-6 * k.positionScale;
+    TwoPointInterpolation unchanged = planner;
+    const double duration = unchanged.replan(t, c.pe + 0.5 * tolerance, c.ve - 0.5 * tolerance, tolerance);
+    replanCheck.expect(same(duration, tr.duration) && sameTrajectory(unchanged.trajectory(), tr)
+                       && unchanged.revision() == planner.revision(), c, t);
+}
+
+// WaypointTrajectory from p0 through a random via point and velocity to pe.
+// It must be accepted exactly when every leg solved on its own has no negative
+// phase. Once accepted, it must follow each leg, and its cursor must agree
+// with getState() bit for bit.
+void checkWaypoints(const Case& k, std::mt19937_64& rng, Check& waypoints) {
+    if (!k.monotone) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const double positions[3] = {c.p0, c.p0 + (c.pe - c.p0) * (0.2 + 0.6 * unit(rng)), c.pe};
+    const double velocities[3] = {c.v0, c.vmax * (2 * unit(rng) - 1), c.ve};
+    WaypointTrajectory path;
+    const double duration = path.calcTrajectory(positions, 3, c.amax, c.vmax, c.t0, velocities);
+
+    TwoPointInterpolation legs[2];
+    bool valid = true;
+    for (std::size_t i = 0; i < 2; ++i) {
+        legs[i].calcTrajectory(positions[i], positions[i + 1], c.amax, c.vmax, 0, velocities[i], velocities[i + 1]);
+        valid = valid && legs[i].isInitialized();
+        for (std::size_t s = 0; valid && s < legs[i].trajectory().segmentCount; ++s) {
+            valid = legs[i].trajectory().dt[s] >= 0;
+        }
+    }
+    waypoints.expect(valid == (duration != -1), c, 0);
+    if (!valid || duration == -1) {
+        return;
+    }
+    const double positionScale = 1.0 + std::max(std::fabs(c.p0), std::fabs(c.pe)) + c.vmax * duration;
+    const double velocityScale = 1.0 + c.vmax + c.amax * duration;
+    WaypointTrajectory::Cursor cursor = path.cursor();
+    for (int m = 0; m <= 200; ++m) {
+        const double t = c.t0 + duration * m / 200.0;
+        const TrajectoryPoint state = path.getState(t);
+        const TrajectoryPoint walked = cursor.getState(t);
+        waypoints.expect(same(state.pos, walked.pos) && same(state.vel, walked.vel) && same(state.acc, walked.acc), c, t);
+        const std::size_t i = t - c.t0 < path.legStartTime(1) ? 0 : 1;
+        const TrajectoryPoint leg = legs[i].getState(t - c.t0 - path.legStartTime(i));
+        const std::vector<double> expected = {leg.pos, leg.vel, leg.acc};
+        waypoints.expectClose(expected, state.pos, state.vel, positionScale, velocityScale, cursorTolerance, c, t);
+    }
+}
+
+// The jerk-limited profile of the same move, which has no reference: no
+// phase is negative, the segments join continuously in position, velocity
+// and acceleration, the last one ends at (pe, ve) with zero acceleration, and
+// |v| <= vmax, |a| <= amax at every segment end and on a grid in between.
+void checkJerk(const ConstraintSet& c, const double jmax, Check& jerkJoin, Check& jerkLimits) {
+    TwoPointInterpolationConstantJerk planner;
+    const double duration = planner.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, jmax, c.t0, c.v0, c.ve);
+    if (!(duration >= 0)) {
+        return;
+    }
+    const ConstantJerkTrajectory& tr = planner.trajectory();
+    const double positionScale = 1.0 + std::max(std::fabs(c.p0), std::fabs(c.pe)) + c.vmax * duration;
+    const double velocityScale = 1.0 + c.vmax + c.amax * duration;
+    const auto expectJoin = [&](const double p, const double v, const double a,
+                                const double pNext, const double vNext, const double aNext, const double t) {
+        const double error = std::max(std::max(std::fabs(p - pNext) / positionScale,
+                                               std::fabs(v - vNext) / velocityScale),
+                                      std::fabs(a - aNext) / c.amax);
+        jerkJoin.expect(error <= continuityTolerance, c, t, error);
+    };
+    const auto expectLimits = [&](const double v, const double a, const double t) {
+        const double excess = std::max(std::fabs(v) / c.vmax, std::fabs(a) / c.amax) - 1.0;
+        jerkLimits.expect(excess <= continuityTolerance, c, t, std::max(excess, 0.0));
+    };
+
+    expectJoin(tr.p[0], tr.v[0], tr.a[0], c.p0, c.v0, 0.0, tr.t0);
+    expectLimits(tr.v[0], tr.a[0], tr.t0);
+    for (std::size_t i = 0; i < tr.segmentCount; ++i) {
+        const double tb = tr.t0 + tr.segmentStart[i + 1];
+        jerkJoin.expect(tr.dt[i] >= 0, c, tb, 0);
+        const double pEnd = pIntegJerk(tr.p[i], tr.v[i], tr.a[i], tr.j[i], tr.dt[i]);
+        const double vEnd = vIntegJerk(tr.v[i], tr.a[i], tr.j[i], tr.dt[i]);
+        const double aEnd = aIntegJerk(tr.a[i], tr.j[i], tr.dt[i]);
+        const bool last = i + 1 == tr.segmentCount;
+        expectJoin(pEnd, vEnd, aEnd, last ? c.pe : tr.p[i + 1], last ? c.ve : tr.v[i + 1],
+                   last ? 0.0 : tr.a[i + 1], tb);
+        expectLimits(vEnd, aEnd, tb);
+    }
+    for (int m = 0; m <= 64; ++m) {
+        const double t = tr.t0 + duration * m / 64.0;
+        const TrajectoryPoint state = planner.getState(t);
+        expectLimits(state.vel, state.acc, t);
+    }
+}
+
+// sampleRange(), sampleStream(), sampleTimes() and the cursor.
+void checkSampling(const Case& k, const reference::TwoPointInterpolation& ref, const TwoPointInterpolation& planner,
+                   Check& range, Check& stream, Check& times, Check& cursor) {
+    if (!k.monotone || !(k.duration > 0)) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    const double tStart = c.t0 - 0.05 * k.duration;
+    const double tEnd = c.t0 + 1.05 * k.duration;
+    const double dt = k.duration / 601.0;
+    const std::size_t n = TwoPointInterpolation::sampleCount(tStart, tEnd, dt);
+    std::vector<double> time(n), pos(n), vel(n), acc(n);
+    planner.sampleRange(tStart, tEnd, dt, time.data(), pos.data(), vel.data(), acc.data());
+    for (std::size_t j = 0; j < n; ++j) {
+        const double t = tStart + static_cast<double>(j) * dt;
+        range.expect(same(time[j], t), c, t);
+        range.expectState(ref.getPoint(t), pos[j], vel[j], acc[j], c, t);
+    }
+
+    std::size_t j = 0;
+    const std::size_t streamed = planner.sampleStream(tStart, tEnd, dt,
+        [&](const double* st, const double* sp, const double* sv, const double* sa, const std::size_t count) {
+            for (std::size_t m = 0; m < count && j < n; ++m, ++j) {
+                stream.expect(same(st[m], time[j]) && same(sp[m], pos[j]) && same(sv[m], vel[j])
+                              && same(sa[m], acc[j]), c, st[m]);
+            }
+        });
+    stream.expect(streamed == n && j == n, c, tEnd);
+
+    std::vector<double> sp(k.times.size()), sv(k.times.size()), sa(k.times.size());
+    planner.sampleTimes(k.times.data(), k.times.size(), sp.data(), sv.data(), sa.data());
+    for (std::size_t m = 0; m < k.times.size(); ++m) {
+        times.expectState(ref.getPoint(k.times[m]), sp[m], sv[m], sa[m], c, k.times[m]);
+    }
+
+    TrajectoryCursor walker(planner.trajectory(), tStart);
+    for (std::size_t m = 0; m < n; ++m) {
+        const TrajectoryPoint& s = m == 0 ? walker.state() : walker.step(dt);
+        cursor.expectClose(ref.getPoint(walker.time()), s.pos, s.vel, k.positionScale, k.velocityScale,
+                           cursorTolerance, c, walker.time());
+    }
+}
+
+// sampleEnvelope(): every bucket equals the bounds queries over its window,
+// and holds every reference sample in it (up to rounding of the vertex).
+void checkEnvelope(const Case& k, const reference::TwoPointInterpolation& ref, const TwoPointInterpolation& planner,
+                   Check& envelope) {
+    if (!k.monotone || !(k.duration > 0)) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    const std::size_t buckets = 64;
+    const double tStart = c.t0 - 0.05 * k.duration;
+    const double tEnd = c.t0 + 1.05 * k.duration;
+    std::vector<double> e(6 * buckets);
+    planner.sampleEnvelope(tStart, tEnd, buckets, &e[0], &e[buckets], &e[2 * buckets], &e[3 * buckets],
+                           &e[4 * buckets], &e[5 * buckets]);
+    const double width = (tEnd - tStart) / static_cast<double>(buckets);
+    for (std::size_t b = 0; b < buckets; ++b) {
+        const double tBegin = tStart + static_cast<double>(b) * width;
+        const double tFinish = b + 1 == buckets ? tEnd : tStart + static_cast<double>(b + 1) * width;
+        const TrajectoryBounds pos = planner.positionBounds(tBegin, tFinish);
+        const TrajectoryBounds vel = planner.velocityBounds(tBegin, tFinish);
+        const TrajectoryBounds acc = planner.accelerationBounds(tBegin, tFinish);
+        envelope.expect(same(pos.lo, e[b]) && same(pos.hi, e[buckets + b]) && same(vel.lo, e[2 * buckets + b])
+                        && same(vel.hi, e[3 * buckets + b]) && same(acc.lo, e[4 * buckets + b])
+                        && same(acc.hi, e[5 * buckets + b]), c, tBegin);
+        for (int m = 0; m <= 16; ++m) {
+            const double t = m == 16 ? tFinish : tBegin + m * (tFinish - tBegin) / 16;
+            const std::vector<double> r = ref.getPoint(t);
+            const double outside = std::max(
+                std::max(e[b] - r[0], r[0] - e[buckets + b]) / k.positionScale,
+                std::max(e[2 * buckets + b] - r[1], r[1] - e[3 * buckets + b]) / k.velocityScale);
+            envelope.expect(outside <= continuityTolerance && r[2] >= e[4 * buckets + b] && r[2] <= e[5 * buckets + b],
+                            c, t, std::max(outside, 0.0));
+        }
+    }
+}
+
+// minimumDuration() and isFeasible() against the reference calcTrajectory():
+// the same duration bit for bit when it finds a profile, -1 and false when
+// it does not.
+void checkMinimumDuration(const Case& k, Check& minimum) {
+    const ConstraintSet& c = k.c;
+    int caseNum = -2;
+    const double duration = minimumDuration(c.p0, c.pe, c.amax, c.vmax, c.v0, c.ve, &caseNum);
+    const bool feasible = isFeasible(c.p0, c.pe, c.amax, c.vmax, c.v0, c.ve);
+    minimum.expect(same(duration, k.solved ? k.duration : -1.0) && feasible == k.solved
+                   && (caseNum == -1) == !k.solved, c, 0);
+}
+
+// timeAtPosition() and timeAtVelocity() of the state at each probe time in
+// [t0, t0 + duration], searched from the start and from the probe time
+// itself: both must find a time in range (not before the probe time for the
+// second) at which getState() reproduces the queried value.
+void checkInverse(const Case& k, const TwoPointInterpolation& planner, Check& inverse) {
+    if (!k.feasible) {
+        return;
+    }
+    const ConstraintSet& c = k.c;
+    const double tEnd = c.t0 + k.duration;
+    for (const double t : k.times) {
+        if (t < c.t0 || t > tEnd) {
+            continue;
+        }
+        const TrajectoryPoint s = planner.getState(t);
+        for (int from = 0; from < 2; ++from) {
+            const double tFrom = from == 0 ? -INFINITY : t;
+            double tPos = NAN;
+            double tVel = NAN;
+            const bool foundPos = planner.timeAtPosition(s.pos, tPos, tFrom);
+            const bool foundVel = planner.timeAtVelocity(s.vel, tVel, tFrom);
+            const double error = std::max(foundPos ? std::fabs(planner.getState(tPos).pos - s.pos) / k.positionScale : 0.0,
+                                          foundVel ? std::fabs(planner.getState(tVel).vel - s.vel) / k.velocityScale : 0.0);
+            const double tLo = from == 0 ? c.t0 : t;
+            inverse.expect(foundPos && foundVel && tPos >= tLo && tPos <= tEnd && tVel >= tLo && tVel <= tEnd
+                           && error <= cursorTolerance, c, t, error);
+        }
+    }
+}
+
+// TrajectoryPublisher and trajectory files over one chunk of moves. Each
+// profile published must load back unchanged under the next version, and
+// each profile written with the reference states at its probe times as
+// samples must read back unchanged, through readTrajectoryFile() and through
+// TrajectoryFileView on the file's bytes, and give those states again.
+void checkRoundTrips(const std::vector<Case>& chunk, const std::vector<reference::TwoPointInterpolation>& refs,
+                     const std::vector<TwoPointInterpolation>& planners, TrajectoryPublisher& publisher,
+                     const std::string& filePath, Check& publisherCheck, Check& file) {
+    for (std::size_t i = 0; i < chunk.size(); ++i) {
+        const Case& k = chunk[i];
+        const ConstraintSet& c = k.c;
+        const ConstantAccTrajectory& tr = planners[i].trajectory();
+        const std::uint64_t version = publisher.version();
+        publisher.publish(planners[i]);
+        ConstantAccTrajectory snapshot{};
+        publisherCheck.expect(publisher.load(snapshot) == version + 1 && sameTrajectory(snapshot, tr), c, 0);
+        for (const double t : k.times) {
+            const TrajectoryPoint s = snapshot.getState(t);
+            publisherCheck.expectState(refs[i].getPoint(t), s.pos, s.vel, s.acc, c, t);
+        }
+
+        const std::size_t m = k.times.size();
+        std::vector<double> pos(m), vel(m), acc(m);
+        for (std::size_t j = 0; j < m; ++j) {
+            const std::vector<double> r = refs[i].getPoint(k.times[j]);
+            pos[j] = r[0];
+            vel[j] = r[1];
+            acc[j] = r[2];
+        }
+        const double* time = m > 0 ? k.times.data() : nullptr;
+        TrajectoryFileData data;
+        const bool stored = writeTrajectoryFile(filePath, tr, time, pos.data(), vel.data(), acc.data(), m)
+            && readTrajectoryFile(filePath, data);
+        bool ok = stored && sameTrajectory(data.trajectory, tr) && data.time.size() == m;
+        for (std::size_t j = 0; ok && j < m; ++j) {
+            const TrajectoryPoint s = data.trajectory.getState(data.time[j]);
+            ok = same(data.time[j], k.times[j]) && same(data.pos[j], pos[j]) && same(data.vel[j], vel[j])
+                && same(data.acc[j], acc[j]) && same(s.pos, pos[j]) && same(s.vel, vel[j]) && same(s.acc, acc[j]);
+        }
+        file.expect(ok, c, 0);
+
+        // the file's bytes in a buffer of doubles, so they are aligned for the view
+        std::ifstream in(filePath, std::ios::binary | std::ios::ate);
+        const std::size_t size = in ? static_cast<std::size_t>(in.tellg()) : 0;
+        std::vector<double> bytes(size / sizeof(double) + 1);
+        in.seekg(0);
+        TrajectoryFileView view;
+        ok = in.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(size))
+            && view.parse(bytes.data(), size) && view.header->segmentCount == tr.segmentCount
+            && view.header->sampleCount == m && same(view.header->duration, tr.duration);
+        for (std::size_t j = 0; ok && j <= tr.segmentCount; ++j) {
+            ok = same(view.segmentStart[j], tr.segmentStart[j]);
+        }
+        for (std::size_t j = 0; ok && j < tr.segmentCount; ++j) {
+            ok = same(view.dt[j], tr.dt[j]) && same(view.a[j], tr.a[j]) && same(view.v[j], tr.v[j])
+                && same(view.p[j], tr.p[j]);
+        }
+        for (std::size_t j = 0; ok && j < m; ++j) {
+            ok = same(view.time[j], k.times[j]) && same(view.pos[j], pos[j]) && same(view.vel[j], vel[j])
+                && same(view.acc[j], acc[j]);
+        }
+        file.expect(ok, c, 0);
+    }
+}
+
+// Batch solvers, the parallel planner, the store and the compact codec over
+// one chunk of moves.
+void checkChunk(const std::vector<Case>& chunk, const std::vector<reference::TwoPointInterpolation>& refs,
+                const std::vector<TwoPointInterpolation>& planners, ParallelTrajectoryPlanner& parallel,
+                TrajectoryStore& store, Check& batch, Check& batchFloat, Check& parallelCheck,
+                Check& storeCheck, Check& codec, Check& cursorFloat) {
+    const std::size_t n = chunk.size();
+    TwoPointInterpolationBatch solver(n);
+    TwoPointInterpolationBatchFloat solverFloat(n);
+    std::vector<double> p0(n), pe(n), amax(n), vmax(n), t0(n), v0(n), ve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = chunk[i].c;
+        solver.setAxis(i, c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        solverFloat.setAxis(i, static_cast<float>(c.p0), static_cast<float>(c.pe), static_cast<float>(c.amax),
+                            static_cast<float>(c.vmax), static_cast<float>(c.t0), static_cast<float>(c.v0),
+                            static_cast<float>(c.ve));
+        p0[i] = c.p0;
+        pe[i] = c.pe;
+        amax[i] = c.amax;
+        vmax[i] = c.vmax;
+        t0[i] = c.t0;
+        v0[i] = c.v0;
+        ve[i] = c.ve;
+    }
+    solver.calcTrajectory();
+    solverFloat.calcTrajectory();
+
+    std::vector<ConstantAccTrajectory> solved(n);
+    std::vector<int> caseNum(n);
+    parallel.calcTrajectories(n, p0.data(), pe.data(), amax.data(), vmax.data(), t0.data(), v0.data(), ve.data(),
+                              solved.data(), caseNum.data());
+
+    store.reset();
+    std::vector<TrajectoryHandle> handles(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = chunk[i].c;
+        handles[i] = store.plan(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+    }
+    // freed slots are reused and their old handles must stay dead
+    for (std::size_t i = 0; i < n; i += 3) {
+        if (store.remove(handles[i])) {
+            const TrajectoryHandle stale = handles[i];
+            const ConstraintSet& c = chunk[i].c;
+            handles[i] = store.plan(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+            storeCheck.expect(!store.contains(stale) && store.get(stale) == nullptr, c, 0);
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const Case& k = chunk[i];
+        const ConstraintSet& c = k.c;
+        const reference::TwoPointInterpolation& ref = refs[i];
+        const ConstantAccTrajectory& expected = planners[i].trajectory();
+
+        // an unsolved move leaves the planner's profile stale, so only the
+        // verdict is compared
+        const bool solvedSame = k.solved ? same(solver.duration(i), k.duration) && solver.caseNum(i) == ref.caseNum()
+                                         : solver.caseNum(i) < 0;
+        batch.expect(solvedSame, c, 0);
+        parallelCheck.expect(k.solved ? caseNum[i] == ref.caseNum() : caseNum[i] < 0, c, 0);
+        storeCheck.expect(k.solved != handles[i].isNull(), c, 0);
+        if (!k.solved) {
+            continue;
+        }
+
+        ConstantAccTrajectory fromBatch;
+        solver.getTrajectory(i, fromBatch);
+        batch.expect(sameTrajectory(fromBatch, expected), c, 0);
+        parallelCheck.expect(sameTrajectory(solved[i], expected), c, 0);
+        const ConstantAccTrajectory* stored = store.get(handles[i]);
+        storeCheck.expect(stored != nullptr && sameTrajectory(*stored, expected), c, 0);
+
+        unsigned char message[compactTrajectoryMaxSize];
+        TwoPointInterpolation decoded;
+        const std::size_t size = encodeCompactTrajectory(planners[i], message, sizeof(message));
+        codec.expect(size > 0 && decodeCompactTrajectory(message, size, decoded) == size
+                     && sameTrajectory(decoded.trajectory(), expected), c, 0);
+
+        for (const double t : k.times) { // empty unless feasible
+            const std::vector<double> r = ref.getPoint(t);
+            const TrajectoryPoint s = solver.getState(i, t);
+            batch.expectState(r, s.pos, s.vel, s.acc, c, t);
+            TrajectoryPoint fromStore;
+            storeCheck.expect(store.getState(handles[i], t, fromStore), c, t);
+            storeCheck.expectState(r, fromStore.pos, fromStore.vel, fromStore.acc, c, t);
+            const TrajectoryPoint d = decoded.getState(t);
+            codec.expectState(r, d.pos, d.vel, d.acc, c, t);
+        }
+    }
+
+    // getPoints() of every axis at shared times, against the reference and,
+    // for float, against the float scalar solver
+    std::vector<double> pos(n), vel(n), acc(n);
+    std::vector<float> posF(n), velF(n), accF(n);
+    std::vector<double> parallelPos(n), parallelVel(n), parallelAcc(n);
+    std::vector<double> storePos(store.slotCount()), storeVel(store.slotCount()), storeAcc(store.slotCount());
+    for (std::size_t m = 0; m < 16; ++m) {
+        const Case& source = chunk[(m * 17) % n];
+        const double t = source.feasible ? source.times[m % source.times.size()] : source.c.t0;
+        solver.getPoints(t, pos.data(), vel.data(), acc.data());
+        solverFloat.getPoints(static_cast<float>(t), posF.data(), velF.data(), accF.data());
+        parallel.getPoints(solved.data(), n, t, parallelPos.data(), parallelVel.data(), parallelAcc.data());
+        store.getPoints(t, storePos.data(), storeVel.data(), storeAcc.data());
+        for (std::size_t i = 0; i < n; ++i) {
+            const Case& k = chunk[i];
+            if (!k.feasible) {
+                continue;
+            }
+            const std::vector<double> r = refs[i].getPoint(t);
+            batch.expectState(r, pos[i], vel[i], acc[i], k.c, t);
+            parallelCheck.expectState(r, parallelPos[i], parallelVel[i], parallelAcc[i], k.c, t);
+            storeCheck.expectState(r, storePos[handles[i].index], storeVel[handles[i].index],
+                                   storeAcc[handles[i].index], k.c, t);
+        }
+    }
+
+    for (std::size_t i = 0; i < n; ++i) {
+        const Case& k = chunk[i];
+        const ConstraintSet& c = k.c;
+        TwoPointInterpolationFloat scalarFloat;
+        const float durationFloat = scalarFloat.calcTrajectory(
+            static_cast<float>(c.p0), static_cast<float>(c.pe), static_cast<float>(c.amax),
+            static_cast<float>(c.vmax), static_cast<float>(c.t0), static_cast<float>(c.v0), static_cast<float>(c.ve));
+        batchFloat.expect(scalarFloat.isInitialized() ? same(solverFloat.duration(i), durationFloat)
+                                                      : solverFloat.caseNum(i) < 0, c, 0);
+        if (!scalarFloat.isInitialized() || !std::isfinite(durationFloat) || !(durationFloat >= 0)) {
+            continue;
+        }
+        bool monotoneFloat = true;
+        for (std::size_t s = 0; s < scalarFloat.trajectory().segmentCount; ++s) {
+            monotoneFloat = monotoneFloat && scalarFloat.trajectory().dt[s] >= 0;
+        }
+        for (const double t : k.times) {
+            const float tf = static_cast<float>(t);
+            const BasicTrajectoryPoint<float> expected = scalarFloat.getState(tf);
+            const BasicTrajectoryPoint<float> s = solverFloat.getState(i, tf);
+            batchFloat.expect(same(s.pos, expected.pos) && same(s.vel, expected.vel) && same(s.acc, expected.acc), c, t);
+            // single precision against the double reference, on ordinary
+            // profiles of moderate scale only: near a case change float may
+            // pick the other case, and large times lose their fraction
+            if (k.monotone && monotoneFloat && solverFloat.caseNum(i) == refs[i].caseNum()
+                && k.positionScale < 1e4 && std::fabs(c.t0) + k.duration < 1e3) {
+                batchFloat.expectClose(refs[i].getPoint(static_cast<double>(tf)), expected.pos, expected.vel,
+                                       k.positionScale, k.velocityScale, floatTolerance, c, t);
+            }
+        }
+
+        // the float cursor against float getState() at the same times
+        if (!monotoneFloat || !(durationFloat > 0) || k.positionScale >= 1e4 || std::fabs(c.t0) + k.duration >= 1e3) {
+            continue;
+        }
+        const float dtFloat = durationFloat / 301.0f;
+        BasicTrajectoryCursor<float> walker = scalarFloat.cursor(static_cast<float>(c.t0) - 0.05f * durationFloat);
+        for (int m = 0; m < 330; ++m) {
+            const BasicTrajectoryPoint<float>& s = m == 0 ? walker.state() : walker.step(dtFloat);
+            const BasicTrajectoryPoint<float> expected = scalarFloat.getState(walker.time());
+            const std::vector<double> e = {expected.pos, expected.vel, expected.acc};
+            cursorFloat.expectClose(e, s.pos, s.vel, k.positionScale, k.velocityScale, cursorFloatTolerance, c,
+                                    walker.time());
+        }
+    }
+}
+
+// calcSynchronizedTrajectory() on groups of axisCount moves, once as they
+// are and once from rest to rest (which can always be stretched): when it
+// succeeds, every axis arrives at the returned time at (pe, ve), joins
+// continuously and keeps |a| <= amax and |v| <= vmax (or the larger boundary
+// velocity).
+void checkSynchronized(const std::vector<Case>& chunk, Check& synchronized) {
+    const std::size_t axisCount = 4;
+    std::vector<const Case*> group;
+    for (const Case& k : chunk) {
+        if (k.monotone) {
+            group.push_back(&k);
+        }
+        if (group.size() < axisCount) {
+            continue;
+        }
+        for (int rest = 0; rest < 2; ++rest) {
+            TwoPointInterpolationBatch solver(axisCount);
+            for (std::size_t i = 0; i < axisCount; ++i) {
+                const ConstraintSet& c = group[i]->c;
+                solver.setAxis(i, c.p0, c.pe, c.amax, c.vmax, c.t0, rest ? 0.0 : c.v0, rest ? 0.0 : c.ve);
+            }
+            // an arrival time, negative when t0 is; exactly -1 reports failure
+            const double arrival = solver.calcSynchronizedTrajectory();
+            if (rest) {
+                synchronized.expect(arrival != -1, group[0]->c, 0);
+            }
+            if (arrival == -1) {
+                continue;
+            }
+            for (std::size_t i = 0; i < axisCount; ++i) {
+                const ConstraintSet& c = group[i]->c;
+                const double v0 = rest ? 0.0 : c.v0;
+                const double ve = rest ? 0.0 : c.ve;
+                ConstantAccTrajectory tr;
+                solver.getTrajectory(i, tr);
+                const double T = arrival - c.t0;
+                const double positionScale = 1.0 + std::max(std::fabs(c.p0), std::fabs(c.pe)) + c.vmax * T;
+                const double velocityScale = 1.0 + c.vmax + c.amax * T;
+                // the boundary velocities may exceed vmax; nothing in between may
+                const double vLimit = std::max(c.vmax, std::max(std::fabs(v0), std::fabs(ve)));
+                const double late = std::fabs(tr.t0 + tr.duration - arrival) / (1.0 + std::fabs(arrival));
+                synchronized.expect(late <= continuityTolerance, c, arrival, late);
+                double p = c.p0;
+                double v = v0;
+                for (std::size_t s = 0; s < tr.segmentCount; ++s) {
+                    const double t = tr.t0 + tr.segmentStart[s];
+                    const double join = std::max(std::fabs(tr.p[s] - p) / positionScale,
+                                                 std::fabs(tr.v[s] - v) / velocityScale);
+                    const double excess = std::max(std::fabs(tr.v[s]) / vLimit, std::fabs(tr.a[s]) / c.amax) - 1.0;
+                    synchronized.expect(tr.dt[s] >= 0 && join <= continuityTolerance, c, t, join);
+                    synchronized.expect(excess <= continuityTolerance, c, t, std::max(excess, 0.0));
+                    p = pInteg(tr.p[s], tr.v[s], tr.a[s], tr.dt[s]);
+                    v = vInteg(tr.v[s], tr.a[s], tr.dt[s]);
+                }
+                const double end = std::max(std::fabs(p - c.pe) / positionScale, std::fabs(v - ve) / velocityScale);
+                const double excess = std::fabs(v) / vLimit - 1.0;
+                synchronized.expect(end <= continuityTolerance && excess <= continuityTolerance, c, arrival, end);
+            }
+        }
+        group.clear();
+    }
+}
+
+// Throughput of the hot paths, in million items per second (best of five
+// runs of at least 20 ms each).
+
+volatile double throughputSink = 0;
+
+template <class Kernel>
+double measureThroughput(Kernel&& kernel, const double itemsPerCall) {
+    typedef std::chrono::steady_clock Clock;
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        std::size_t calls = 0;
+        double checksum = 0;
+        const Clock::time_point start = Clock::now();
+        double elapsed = 0;
+        do {
+            checksum += kernel();
+            ++calls;
+            elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        } while (elapsed < 0.02);
+        throughputSink = throughputSink + checksum;
+        best = std::max(best, static_cast<double>(calls) * itemsPerCall / elapsed * 1e-6);
+    }
+    return best;
+}
+
+std::vector<std::pair<std::string, double>> measureAll(const std::vector<ConstraintSet>& pool) {
+    std::vector<std::pair<std::string, double>> results;
+    const std::size_t n = pool.size();
+
+    TwoPointInterpolation planner;
+    results.push_back(std::make_pair("calcTrajectory", measureThroughput([&]() {
+        double sum = 0;
+        for (const ConstraintSet& c : pool) {
+            sum += planner.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        }
+        return sum;
+    }, static_cast<double>(n))));
+
+    std::vector<TwoPointInterpolation> planners(n);
+    std::vector<double> queryTimes(n);
+    std::mt19937_64 rng(7);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = pool[i];
+        const double duration = planners[i].calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        queryTimes[i] = std::uniform_real_distribution<double>(c.t0, c.t0 + duration)(rng);
+    }
+    results.push_back(std::make_pair("getState", measureThroughput([&]() {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += planners[i].getState(queryTimes[i]).pos;
+        }
+        return sum;
+    }, static_cast<double>(n))));
+
+    const ConstantAccTrajectory& longest = planners[0].trajectory();
+    const double dt = longest.duration / 4096.0;
+    const std::size_t samples = ConstantAccTrajectory::sampleCount(longest.t0, longest.t0 + longest.duration, dt);
+    std::vector<double> time(samples), pos(samples), vel(samples), acc(samples);
+    results.push_back(std::make_pair("sampleRange", measureThroughput([&]() {
+        longest.sampleRange(longest.t0, longest.t0 + longest.duration, dt, time.data(), pos.data(), vel.data(), acc.data());
+        return pos[samples / 2];
+    }, static_cast<double>(samples))));
+
+    results.push_back(std::make_pair("cursorStep", measureThroughput([&]() {
+        TrajectoryCursor cursor(longest, longest.t0);
+        double sum = 0;
+        for (std::size_t k = 0; k < samples; ++k) {
+            sum += cursor.step(dt).pos;
+        }
+        return sum;
+    }, static_cast<double>(samples))));
+
+    TwoAngleInterpolation angle;
+    angle.setFastNormalization(true);
+    angle.calcTrajectory(0.0, 3.0, 1.0, 2.0);
+    results.push_back(std::make_pair("angleGetStateFast", measureThroughput([&]() {
+        double sum = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            sum += angle.getState(queryTimes[i] - pool[i].t0).pos;
+        }
+        return sum;
+    }, static_cast<double>(n))));
+
+    TwoPointInterpolationBatch batch(n);
+    TwoPointInterpolationBatchFloat batchFloat(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const ConstraintSet& c = pool[i];
+        batch.setAxis(i, c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        batchFloat.setAxis(i, static_cast<float>(c.p0), static_cast<float>(c.pe), static_cast<float>(c.amax),
+                           static_cast<float>(c.vmax), static_cast<float>(c.t0), static_cast<float>(c.v0),
+                           static_cast<float>(c.ve));
+    }
+    results.push_back(std::make_pair("batchCalcTrajectory", measureThroughput([&]() {
+        return batch.calcTrajectory();
+    }, static_cast<double>(n))));
+    results.push_back(std::make_pair("batchFloatCalcTrajectory", measureThroughput([&]() {
+        return static_cast<double>(batchFloat.calcTrajectory());
+    }, static_cast<double>(n))));
+
+    std::vector<double> batchPos(n), batchVel(n), batchAcc(n);
+    double t = 0;
+    results.push_back(std::make_pair("batchGetPoints", measureThroughput([&]() {
+        t = t > 10 ? 0 : t + 0.01;
+        batch.getPoints(t, batchPos.data(), batchVel.data(), batchAcc.data());
+        return batchPos[n / 2];
+    }, static_cast<double>(n))));
+
+    TrajectoryStore store(n);
+    results.push_back(std::make_pair("storePlanReset", measureThroughput([&]() {
+        store.reset();
+        for (const ConstraintSet& c : pool) {
+            store.plan(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        }
+        return static_cast<double>(store.size());
+    }, static_cast<double>(n))));
+    return results;
+}
+
+// "name value" lines; '#' starts a comment.
+bool readBaselines(const std::string& path, std::map<std::string, double>& baselines) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line.substr(0, line.find('#')));
+        std::string name;
+        double value = 0;
+        if (fields >> name >> value) {
+            baselines[name] = value;
+        }
+    }
+    return true;
+}
+
+bool writeBaselines(const std::string& path, const std::vector<std::pair<std::string, double>>& measured) {
+    std::ofstream out(path);
+    out << "# Throughput floors of TwoPointsInterpolationDifferentialCheck in million items\n"
+        << "# per second, recorded on the machine that runs the check. Delete this file\n"
+        << "# to record new ones.\n";
+    for (const auto& entry : measured) {
+        out << entry.first << " " << entry.second << "\n";
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::string baselinesPath = argc > 1 ? argv[1] : "differential_check_baselines.txt";
+    const std::size_t caseCount = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20000;
+    const std::uint64_t seed = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 1;
+
+    Check solve{"calcTrajectory"};
+    Check state{"getState"};
+    Check angle{"TwoAngleInterpolation"};
+    Check fastAngle{"fastNormalization_ulps"};
+    Check continuity{"continuity_relative"};
+    Check range{"sampleRange"};
+    Check stream{"sampleStream"};
+    Check times{"sampleTimes"};
+    Check cursor{"cursor_relative"};
+    Check envelope{"envelope_relative"};
+    Check batch{"batch"};
+    Check batchFloat{"batchFloat_relative"};
+    Check parallelCheck{"parallel"};
+    Check storeCheck{"store"};
+    Check codec{"compactCodec"};
+    Check cursorFloat{"cursorFloat_relative"};
+    Check jerkJoin{"jerkContinuity_relative"};
+    Check jerkLimits{"jerkLimits_excess"};
+    Check synchronized{"synchronized_relative"};
+    Check replanCheck{"replan"};
+    Check waypoints{"waypoints_relative"};
+    Check inverse{"inverse_relative"};
+    Check minimum{"minimumDuration"};
+    Check publisherCheck{"publisher"};
+    Check file{"trajectoryFile"};
+    Check* const checks[] = {&solve, &state, &angle, &fastAngle, &continuity, &range, &stream, &times, &cursor,
+                             &envelope, &batch, &batchFloat, &parallelCheck, &storeCheck, &codec,
+                             &cursorFloat, &jerkJoin, &jerkLimits, &synchronized,
+                             &replanCheck, &waypoints, &inverse, &minimum,
+                             &publisherCheck, &file};
+
+    // the default sweep, a wide one whose boundary velocities often exceed
+    // vmax, and the edge cases
+    ConstraintSweep sweep(seed);
+    ConstraintSweep wideSweep(seed + 1, 1e3, 0.01, 50.0, 0.1, 100.0, 1.5, 1e3);
+    std::vector<ConstraintSet> sets = edgeCases();
+    for (std::size_t i = 0; i < caseCount; ++i) {
+        sets.push_back(i % 4 == 3 ? wideSweep.next() : sweep.next());
+    }
+
+    std::mt19937_64 rng(seed);
+    // jmax from amax / 100 to 1000 * amax per second, so the ramps reach amax
+    // on some moves and not on others
+    std::mt19937_64 jerkRng(seed + 2);
+    std::mt19937_64 replanRng(seed + 3);
+    std::mt19937_64 waypointRng(seed + 4);
+    std::uniform_real_distribution<double> jerkRatio(std::log(0.01), std::log(1000.0));
+    ParallelTrajectoryPlanner parallel(2, 64);
+    TrajectoryStore store(chunkSize);
+    TrajectoryPublisher publisher;
+    const std::string filePath = "differential_check_trajectory.bin";
+    std::size_t infeasible = 0;
+    std::size_t negativePhase = 0;
+    std::vector<Case> chunk;
+    std::vector<reference::TwoPointInterpolation> refs;
+    std::vector<TwoPointInterpolation> planners;
+    for (std::size_t i = 0; i < sets.size(); ++i) {
+        const ConstraintSet& c = sets[i];
+        reference::TwoPointInterpolation ref;
+        TwoPointInterpolation planner;
+        const double duration = ref.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve);
+        solve.expect(same(duration, planner.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve)), c, 0);
+        solve.expect(ref.isInitialized() == planner.isInitialized(), c, 0);
+        const Case k = makeCase(c, ref.isInitialized(), duration, planner, rng);
+        infeasible += k.solved ? 0 : 1;
+        negativePhase += k.feasible && !k.monotone ? 1 : 0;
+
+        checkScalar(k, ref, planner, solve, state, angle, fastAngle);
+        checkContinuity(k, planner, continuity);
+        checkSampling(k, ref, planner, range, stream, times, cursor);
+        checkEnvelope(k, ref, planner, envelope);
+        checkInverse(k, planner, inverse);
+        checkMinimumDuration(k, minimum);
+        checkReplan(k, planner, replanRng, replanCheck);
+        checkWaypoints(k, waypointRng, waypoints);
+        checkJerk(c, c.amax * std::exp(jerkRatio(jerkRng)), jerkJoin, jerkLimits);
+
+        chunk.push_back(k);
+        refs.push_back(ref);
+        planners.push_back(planner);
+        if (chunk.size() == chunkSize || i + 1 == sets.size()) {
+            checkChunk(chunk, refs, planners, parallel, store, batch, batchFloat, parallelCheck, storeCheck, codec,
+                       cursorFloat);
+            checkSynchronized(chunk, synchronized);
+            checkRoundTrips(chunk, refs, planners, publisher, filePath, publisherCheck, file);
+            chunk.clear();
+            refs.clear();
+            planners.clear();
+        }
+    }
+    std::remove(filePath.c_str());
+
+    bool ok = true;
+    std::printf("%zu moves (%zu infeasible, %zu with a negative phase)\n", sets.size(), infeasible, negativePhase);
+    for (const Check* check : checks) {
+        std::printf("%-24s %10zu compared %6zu failed  max error %.3g\n", check->name, check->compared,
+                    check->failures, check->maxError);
+        ok = ok && check->failures == 0;
+    }
+
+    if (baselinesPath != "-") {
+        std::vector<ConstraintSet> pool;
+        ConstraintSweep perfSweep(seed);
+        while (pool.size() < 1024) {
+            const ConstraintSet c = perfSweep.next();
+            TwoPointInterpolation planner;
+            if (planner.calcTrajectory(c.p0, c.pe, c.amax, c.vmax, c.t0, c.v0, c.ve) > 0) {
+                pool.push_back(c);
+            }
+        }
+        const std::vector<std::pair<std::string, double>> measured = measureAll(pool);
+        std::map<std::string, double> baselines;
+        const bool recorded = !readBaselines(baselinesPath, baselines);
+        if (recorded && !writeBaselines(baselinesPath, measured)) {
+            std::cerr << "Failed to write " << baselinesPath << std::endl;
+            ok = false;
+        }
+        for (const auto& entry : measured) {
+            const auto found = baselines.find(entry.first);
+            const bool slow = found != baselines.end() && entry.second < throughputSlack * found->second;
+            if (found == baselines.end()) {
+                std::printf("%-24s %10.2f M/s\n", entry.first.c_str(), entry.second);
+            } else {
+                std::printf("%-24s %10.2f M/s  floor %.2f%s\n", entry.first.c_str(), entry.second, found->second,
+                            slow ? "  TOO SLOW" : "");
+            }
+            ok = ok && !slow;
+        }
+        if (recorded) {
+            std::printf("recorded baselines in %s\n", baselinesPath.c_str());
+        }
+    }
+
+    std::printf("%s\n", ok ? "PASSED" : "FAILED");
+    return ok ? 0 : 1;
+}
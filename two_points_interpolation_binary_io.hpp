@@ -0,0 +1,768 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Binary trajectory files: the segment form of a profile plus optional
+// uniform samples, stored exactly (IEEE doubles, little-endian) so large
+// sampled trajectories can be saved and loaded without text formatting.
+//
+// Layout, all offsets in bytes from the start of the file:
+//   TrajectoryFileHeader (128 bytes)
+//   at segmentOffset: segmentStart[segmentCount + 1], dt, a, v, p[segmentCount]
+//   at sampleOffset:  time, pos, vel, acc[sampleCount]
+// Both sections start on a 64-byte boundary, so a memory-mapped file can be
+// used in place through TrajectoryFileView on little-endian hosts.
+
+struct TrajectoryFileHeader {
+    char magic[8];              // "TPITRAJ" and a terminating zero
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t segmentCount;
+    std::uint64_t sampleCount;
+    std::uint64_t segmentOffset;
+    std::uint64_t sampleOffset;
+    double t0;
+    double duration;
+    double p0;
+    double v0;
+    double pe;
+    double ve;
+    double sampleStart;         // time of the first sample
+    double sampleStep;          // sample spacing, 0 if the samples are not uniform
+    std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(TrajectoryFileHeader) == 128, "TrajectoryFileHeader must be 128 bytes");
+
+const char trajectoryFileMagic[8] = {'T', 'P', 'I', 'T', 'R', 'A', 'J', '\0'};
+const std::uint32_t trajectoryFileVersion = 1;
+
+namespace two_points_interpolation_binary_io_detail {
+
+inline bool hostIsLittleEndian() noexcept {
+    const std::uint16_t probe = 1;
+    unsigned char first = 0;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+template <class T>
+inline T byteSwap(const T value) noexcept {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    for (std::size_t i = 0; i < sizeof(T) / 2; ++i) {
+        const unsigned char tmp = bytes[i];
+        bytes[i] = bytes[sizeof(T) - 1 - i];
+        bytes[sizeof(T) - 1 - i] = tmp;
+    }
+    T result;
+    std::memcpy(&result, bytes, sizeof(T));
+    return result;
+}
+
+inline std::uint64_t alignOffset(const std::uint64_t offset) noexcept {
+    return (offset + 63) / 64 * 64;
+}
+
+inline void swapHeader(TrajectoryFileHeader& h) noexcept {
+    h.version = byteSwap(h.version);
+    h.headerSize = byteSwap(h.headerSize);
+    h.segmentCount = byteSwap(h.segmentCount);
+    h.sampleCount = byteSwap(h.sampleCount);
+    h.segmentOffset = byteSwap(h.segmentOffset);
+    h.sampleOffset = byteSwap(h.sampleOffset);
+    h.t0 = byteSwap(h.t0);
+    h.duration = byteSwap(h.duration);
+    h.p0 = byteSwap(h.p0);
+    h.v0 = byteSwap(h.v0);
+    h.pe = byteSwap(h.pe);
+    h.ve = byteSwap(h.ve);
+    h.sampleStart = byteSwap(h.sampleStart);
+    h.sampleStep = byteSwap(h.sampleStep);
+}
+
+inline bool writeDoubles(std::FILE* file, const double* values, const std::size_t count) {
+    if (count == 0) {
+        return true;
+    }
+    if (hostIsLittleEndian()) {
+        return std::fwrite(values, sizeof(double), count, file) == count;
+    }
+    double chunk[512];
+    for (std::size_t i = 0; i < count; i += 512) {
+        const std::size_t n = count - i < 512 ? count - i : 512;
+        for (std::size_t j = 0; j < n; ++j) {
+            chunk[j] = byteSwap(values[i + j]);
+        }
+        if (std::fwrite(chunk, sizeof(double), n, file) != n) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool readDoubles(std::FILE* file, std::vector<double>& values, const std::size_t count) {
+    values.resize(count);
+    if (count > 0 && std::fread(values.data(), sizeof(double), count, file) != count) {
+        return false;
+    }
+    if (!hostIsLittleEndian()) {
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = byteSwap(values[i]);
+        }
+    }
+    return true;
+}
+
+inline bool pad(std::FILE* file, const std::uint64_t from, const std::uint64_t to) {
+    static const char zeros[64] = {};
+    return to == from || std::fwrite(zeros, 1, static_cast<std::size_t>(to - from), file) == to - from;
+}
+
+// Header with the offsets filled in for the given sizes.
+inline TrajectoryFileHeader makeHeader(const ConstantAccTrajectory& trajectory, const std::size_t sampleCount,
+                                       const double sampleStart, const double sampleStep) noexcept {
+    TrajectoryFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, trajectoryFileMagic, sizeof(h.magic));
+    h.version = trajectoryFileVersion;
+    h.headerSize = sizeof(TrajectoryFileHeader);
+    h.segmentCount = trajectory.segmentCount;
+    h.sampleCount = sampleCount;
+    h.segmentOffset = alignOffset(sizeof(TrajectoryFileHeader));
+    h.sampleOffset = alignOffset(h.segmentOffset + (5 * h.segmentCount + 1) * sizeof(double));
+    h.t0 = trajectory.t0;
+    h.duration = trajectory.duration;
+    h.p0 = trajectory.p0;
+    h.v0 = trajectory.v0;
+    h.pe = trajectory.pe;
+    h.ve = trajectory.ve;
+    h.sampleStart = sampleStart;
+    h.sampleStep = sampleStep;
+    return h;
+}
+
+// Whether h describes sections that fit in a file of size bytes. Written so
+// that no hostile count or offset can overflow.
+inline bool validHeader(const TrajectoryFileHeader& h, const std::uint64_t size) noexcept {
+    return h.version == trajectoryFileVersion && h.headerSize == sizeof(TrajectoryFileHeader)
+        && h.segmentCount <= ConstantAccTrajectory::maxSegments
+        && h.segmentOffset % alignof(double) == 0 && h.sampleOffset % alignof(double) == 0
+        && h.segmentOffset <= size && 5 * h.segmentCount + 1 <= (size - h.segmentOffset) / sizeof(double)
+        && h.sampleOffset <= size && h.sampleCount <= (size - h.sampleOffset) / (4 * sizeof(double));
+}
+
+} // namespace two_points_interpolation_binary_io_detail
+
+// Writes trajectory and, if sampleCount > 0, the sample arrays (for example
+// those filled by sampleRange). Returns false if the file cannot be written.
+inline bool writeTrajectoryFile(const std::string& filePath, const ConstantAccTrajectory& trajectory,
+                                const double* time, const double* pos, const double* vel, const double* acc,
+                                const std::size_t sampleCount,
+                                const double sampleStart = 0, const double sampleStep = 0) {
+    namespace detail = two_points_interpolation_binary_io_detail;
+    std::FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    const TrajectoryFileHeader h = detail::makeHeader(trajectory, sampleCount, sampleStart, sampleStep);
+    TrajectoryFileHeader stored = h;
+    if (!detail::hostIsLittleEndian()) {
+        detail::swapHeader(stored);
+    }
+    const std::size_t n = trajectory.segmentCount;
+    const std::uint64_t segmentEnd = h.segmentOffset + (5 * n + 1) * sizeof(double);
+    bool ok = std::fwrite(&stored, sizeof(stored), 1, file) == 1
+        && detail::pad(file, sizeof(TrajectoryFileHeader), h.segmentOffset)
+        && detail::writeDoubles(file, trajectory.segmentStart.data(), n + 1)
+        && detail::writeDoubles(file, trajectory.dt.data(), n)
+        && detail::writeDoubles(file, trajectory.a.data(), n)
+        && detail::writeDoubles(file, trajectory.v.data(), n)
+        && detail::writeDoubles(file, trajectory.p.data(), n)
+        && detail::pad(file, segmentEnd, h.sampleOffset)
+        && detail::writeDoubles(file, time, sampleCount)
+        && detail::writeDoubles(file, pos, sampleCount)
+        && detail::writeDoubles(file, vel, sampleCount)
+        && detail::writeDoubles(file, acc, sampleCount);
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Writes only the segment form of trajectory.
+inline bool writeTrajectoryFile(const std::string& filePath, const ConstantAccTrajectory& trajectory) {
+    return writeTrajectoryFile(filePath, trajectory, nullptr, nullptr, nullptr, nullptr, 0);
+}
+
+// Contents of a trajectory file loaded into memory.
+struct TrajectoryFileData {
+    TrajectoryFileHeader header;
+    ConstantAccTrajectory trajectory;
+    std::vector<double> time;
+    std::vector<double> pos;
+    std::vector<double> vel;
+    std::vector<double> acc;
+};
+
+// Reads a file written by writeTrajectoryFile on hosts of either byte order.
+// Returns false if it cannot be read, is not a supported trajectory file or is
+// shorter than its header says.
+inline bool readTrajectoryFile(const std::string& filePath, TrajectoryFileData& out) {
+    namespace detail = two_points_interpolation_binary_io_detail;
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        size = std::ftell(file);
+    }
+    TrajectoryFileHeader& h = out.header;
+    bool ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0
+        && std::fread(&h, sizeof(h), 1, file) == 1
+        && std::memcmp(h.magic, trajectoryFileMagic, sizeof(h.magic)) == 0;
+    if (ok && !detail::hostIsLittleEndian()) {
+        detail::swapHeader(h);
+    }
+    ok = ok && detail::validHeader(h, static_cast<std::uint64_t>(size));
+
+    std::vector<double> segments;
+    const std::size_t n = ok ? static_cast<std::size_t>(h.segmentCount) : 0;
+    ok = ok && std::fseek(file, static_cast<long>(h.segmentOffset), SEEK_SET) == 0
+        && detail::readDoubles(file, segments, 5 * n + 1)
+        && std::fseek(file, static_cast<long>(h.sampleOffset), SEEK_SET) == 0
+        && detail::readDoubles(file, out.time, static_cast<std::size_t>(h.sampleCount))
+        && detail::readDoubles(file, out.pos, static_cast<std::size_t>(h.sampleCount))
+        && detail::readDoubles(file, out.vel, static_cast<std::size_t>(h.sampleCount))
+        && detail::readDoubles(file, out.acc, static_cast<std::size_t>(h.sampleCount));
+    std::fclose(file);
+    if (!ok) {
+        return false;
+    }
+
+    ConstantAccTrajectory& trajectory = out.trajectory;
+    trajectory = ConstantAccTrajectory();
+    trajectory.clearSegments();
+    trajectory.t0 = h.t0;
+    trajectory.p0 = h.p0;
+    trajectory.v0 = h.v0;
+    trajectory.pe = h.pe;
+    trajectory.ve = h.ve;
+    trajectory.segmentCount = n;
+    for (std::size_t i = 0; i <= n; ++i) {
+        trajectory.segmentStart[i] = segments[i];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+        trajectory.dt[i] = segments[n + 1 + i];
+        trajectory.a[i] = segments[2 * n + 1 + i];
+        trajectory.v[i] = segments[3 * n + 1 + i];
+        trajectory.p[i] = segments[4 * n + 1 + i];
+    }
+    trajectory.duration = h.duration;
+    return true;
+}
+
+// Zero-copy view of a trajectory file already in memory, typically mapped
+// with mmap. The arrays point into the buffer, which must stay alive and be
+// 8-byte aligned. Only available on little-endian hosts; parse() fails elsewhere.
+struct TrajectoryFileView {
+    const TrajectoryFileHeader* header;
+    const double* segmentStart;
+    const double* dt;
+    const double* a;
+    const double* v;
+    const double* p;
+    const double* time;
+    const double* pos;
+    const double* vel;
+    const double* acc;
+
+    bool parse(const void* data, const std::size_t size) noexcept {
+        namespace detail = two_points_interpolation_binary_io_detail;
+        if (!detail::hostIsLittleEndian() || size < sizeof(TrajectoryFileHeader)
+            || reinterpret_cast<std::uintptr_t>(data) % alignof(double) != 0) {
+            return false;
+        }
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        const TrajectoryFileHeader* h = reinterpret_cast<const TrajectoryFileHeader*>(bytes);
+        if (std::memcmp(h->magic, trajectoryFileMagic, sizeof(h->magic)) != 0
+            || !detail::validHeader(*h, size)) {
+            return false;
+        }
+        const std::size_t n = static_cast<std::size_t>(h->segmentCount);
+        const std::size_t m = static_cast<std::size_t>(h->sampleCount);
+        header = h;
+        segmentStart = reinterpret_cast<const double*>(bytes + h->segmentOffset);
+        dt = segmentStart + n + 1;
+        a = dt + n;
+        v = a + n;
+        p = v + n;
+        time = reinterpret_cast<const double*>(bytes + h->sampleOffset);
+        pos = time + m;
+        vel = pos + m;
+        acc = vel + m;
+        return true;
+    }
+};
+
+// Compact messages: the segment form of one profile in 26 to 154 bytes (82
+// for a three-segment profile from rest to rest), for sending planned
+// trajectories to other processes or machines. The receiver gets back exactly
+// the same ConstantAccTrajectory (or TwoPointInterpolation) without solving
+// anything. Messages carry no length prefix; the decoder
+// reports how many bytes it consumed, so messages can be concatenated.
+//
+// Layout:
+//   byte 0: compactTrajectoryVersion
+//   byte 1: flags
+//     bits 0-1  segment count
+//     bit 2     v0 stored (otherwise +0)
+//     bit 3     ve stored (otherwise +0)
+//     bit 4     generic layout, otherwise solver layout
+//     bit 5     constraints amax, vmax stored
+//   little-endian doubles: t0, p0, [v0], pe, [ve], [amax, vmax], then
+//     solver layout:  a0, dt[count], v1 (count >= 2), p1 (count >= 2), p2 (count == 3)
+//     generic layout: dt[i], a[i], v[i], p[i] for every segment
+// The solver layout stores only what solveConstantAccTrajectory does not
+// repeat: segment 0 starts at (p0, v0) with acceleration a0, a two-segment
+// profile decelerates at -a0 from (p1, v1), and a three-segment one coasts
+// at v1 from p1 and decelerates at -a0 from (p2, v1). Any other profile uses
+// the generic layout.
+
+const std::uint8_t compactTrajectoryVersion = 1;
+
+// Largest message encodeCompactTrajectory writes.
+const std::size_t compactTrajectoryMaxSize = 2 + 8 * (7 + 4 * ConstantAccTrajectory::maxSegments);
+
+namespace two_points_interpolation_binary_io_detail {
+
+const std::uint8_t compactSegmentMask = 0x03;
+const std::uint8_t compactHasV0 = 0x04;
+const std::uint8_t compactHasVe = 0x08;
+const std::uint8_t compactGeneric = 0x10;
+const std::uint8_t compactHasConstraints = 0x20;
+
+// Bitwise equality, so -0 and NaN payloads survive a round trip.
+inline bool sameBits(const double a, const double b) noexcept {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+inline bool isPositiveZero(const double value) noexcept {
+    return sameBits(value, 0.0);
+}
+
+inline bool hasSolverLayout(const ConstantAccTrajectory& t) noexcept {
+    const std::size_t n = t.segmentCount;
+    if (n == 0) {
+        return true;
+    }
+    if (!sameBits(t.v[0], t.v0) || !sameBits(t.p[0], t.p0)) {
+        return false;
+    }
+    if (n == 2) {
+        return sameBits(t.a[1], -t.a[0]);
+    }
+    if (n == 3) {
+        return sameBits(t.a[1], 0.0) && sameBits(t.a[2], -t.a[0]) && sameBits(t.v[2], t.v[1]);
+    }
+    return true;
+}
+
+struct CompactWriter {
+    unsigned char* out;
+    std::size_t capacity;
+    std::size_t size;
+
+    void put(double value) noexcept {
+        if (size + sizeof(double) <= capacity) {
+            if (!hostIsLittleEndian()) {
+                value = byteSwap(value);
+            }
+            std::memcpy(out + size, &value, sizeof(double));
+        }
+        size += sizeof(double);
+    }
+};
+
+struct CompactReader {
+    const unsigned char* data;
+    std::size_t size;
+    std::size_t offset;
+
+    bool get(double& value) noexcept {
+        if (offset + sizeof(double) > size) {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(double));
+        if (!hostIsLittleEndian()) {
+            value = byteSwap(value);
+        }
+        offset += sizeof(double);
+        return true;
+    }
+};
+
+inline std::size_t encodeCompact(const ConstantAccTrajectory& t, const double* constraints,
+                                 unsigned char* out, const std::size_t capacity) noexcept {
+    const std::size_t n = t.segmentCount;
+    const bool generic = !hasSolverLayout(t);
+    std::uint8_t flags = static_cast<std::uint8_t>(n);
+    flags |= isPositiveZero(t.v0) ? 0 : compactHasV0;
+    flags |= isPositiveZero(t.ve) ? 0 : compactHasVe;
+    flags |= generic ? compactGeneric : 0;
+    flags |= constraints ? compactHasConstraints : 0;
+
+    CompactWriter w = {out, capacity, 2};
+    w.put(t.t0);
+    w.put(t.p0);
+    if (flags & compactHasV0) {
+        w.put(t.v0);
+    }
+    w.put(t.pe);
+    if (flags & compactHasVe) {
+        w.put(t.ve);
+    }
+    if (constraints) {
+        w.put(constraints[0]);
+        w.put(constraints[1]);
+    }
+    if (generic) {
+        for (std::size_t i = 0; i < n; ++i) {
+            w.put(t.dt[i]);
+            w.put(t.a[i]);
+            w.put(t.v[i]);
+            w.put(t.p[i]);
+        }
+    } else if (n > 0) {
+        w.put(t.a[0]);
+        for (std::size_t i = 0; i < n; ++i) {
+            w.put(t.dt[i]);
+        }
+        if (n >= 2) {
+            w.put(t.v[1]);
+            w.put(t.p[1]);
+        }
+        if (n == 3) {
+            w.put(t.p[2]);
+        }
+    }
+    if (w.size > capacity) {
+        return 0;
+    }
+    out[0] = compactTrajectoryVersion;
+    out[1] = flags;
+    return w.size;
+}
+
+inline std::size_t decodeCompact(const unsigned char* data, const std::size_t size,
+                                 ConstantAccTrajectory& t, double* constraints, bool& hasConstraints) noexcept {
+    if (size < 2 || data[0] != compactTrajectoryVersion) {
+        return 0;
+    }
+    const std::uint8_t flags = data[1];
+    const std::size_t n = flags & compactSegmentMask;
+    if ((flags & ~(compactSegmentMask | compactHasV0 | compactHasVe | compactGeneric | compactHasConstraints)) != 0
+        || n > ConstantAccTrajectory::maxSegments) {
+        return 0;
+    }
+    CompactReader r = {data, size, 2};
+    ConstantAccTrajectory result = ConstantAccTrajectory();
+    result.clearSegments();
+    result.v0 = 0.0;
+    result.ve = 0.0;
+    bool ok = r.get(result.t0) && r.get(result.p0)
+        && (!(flags & compactHasV0) || r.get(result.v0))
+        && r.get(result.pe)
+        && (!(flags & compactHasVe) || r.get(result.ve));
+    hasConstraints = (flags & compactHasConstraints) != 0;
+    if (hasConstraints) {
+        ok = ok && r.get(constraints[0]) && r.get(constraints[1]);
+    }
+    if (flags & compactGeneric) {
+        for (std::size_t i = 0; ok && i < n; ++i) {
+            double dt = 0, a = 0, v = 0, p = 0;
+            ok = r.get(dt) && r.get(a) && r.get(v) && r.get(p);
+            result.addSegment(dt, a, v, p);
+        }
+    } else if (ok && n > 0) {
+        double a0 = 0, v1 = 0, p1 = 0, p2 = 0;
+        double dt[ConstantAccTrajectory::maxSegments] = {};
+        ok = r.get(a0);
+        for (std::size_t i = 0; ok && i < n; ++i) {
+            ok = r.get(dt[i]);
+        }
+        ok = ok && (n < 2 || (r.get(v1) && r.get(p1))) && (n < 3 || r.get(p2));
+        if (ok) {
+            result.addSegment(dt[0], a0, result.v0, result.p0);
+            if (n == 2) {
+                result.addSegment(dt[1], -a0, v1, p1);
+            } else if (n == 3) {
+                result.addSegment(dt[1], 0.0, v1, p1);
+                result.addSegment(dt[2], -a0, v1, p2);
+            }
+        }
+    }
+    if (!ok) {
+        return 0;
+    }
+    t = result;
+    return r.offset;
+}
+
+} // namespace two_points_interpolation_binary_io_detail
+
+// Encodes trajectory into out, which holds capacity bytes (at most
+// compactTrajectoryMaxSize are needed). Returns the message size, or 0 if it
+// does not fit.
+inline std::size_t encodeCompactTrajectory(const ConstantAccTrajectory& trajectory,
+                                           unsigned char* out, const std::size_t capacity) noexcept {
+    return two_points_interpolation_binary_io_detail::encodeCompact(trajectory, nullptr, out, capacity);
+}
+
+// Same, with the constraints of the planner, so the receiver can replan.
+inline std::size_t encodeCompactTrajectory(const TwoPointInterpolation& planner,
+                                           unsigned char* out, const std::size_t capacity) noexcept {
+    const double constraints[2] = {planner.amax(), planner.vmax()};
+    return two_points_interpolation_binary_io_detail::encodeCompact(planner.trajectory(), constraints, out, capacity);
+}
+
+// Decodes one message from the first size bytes of data into out. Returns
+// the number of bytes consumed, or 0 (leaving out untouched) if the message
+// is truncated, malformed or of another version.
+inline std::size_t decodeCompactTrajectory(const unsigned char* data, const std::size_t size,
+                                           ConstantAccTrajectory& out) noexcept {
+    double constraints[2] = {0.0, 0.0};
+    bool hasConstraints = false;
+    return two_points_interpolation_binary_io_detail::decodeCompact(data, size, out, constraints, hasConstraints);
+}
+
+// Decodes a message written with the planner overload straight into a
+// ready-to-query planner (see TwoPointInterpolation::setTrajectory). Returns
+// 0 as above, and also when the message has no constraints.
+inline std::size_t decodeCompactTrajectory(const unsigned char* data, const std::size_t size,
+                                           TwoPointInterpolation& out) {
+    ConstantAccTrajectory trajectory;
+    double constraints[2] = {0.0, 0.0};
+    bool hasConstraints = false;
+    const std::size_t used = two_points_interpolation_binary_io_detail::decodeCompact(
+        data, size, trajectory, constraints, hasConstraints);
+    if (used == 0 || !hasConstraints) {
+        return 0;
+    }
+    out.setTrajectory(trajectory, constraints[0], constraints[1]);
+    return used;
+}
+
+// Envelope files: the sampleEnvelope() buckets of many trajectories in one
+// file, so a single viewer process can draw a whole batch at screen
+// resolution without sampling, text parsing or one plot process per move.
+//
+// Layout, all offsets in bytes from the start of the file:
+//   EnvelopeFileHeader (64 bytes)
+//   at spanOffset:   tStart[trajectoryCount], tEnd[trajectoryCount]
+//   at recordOffset: per trajectory, recordSize bytes of
+//                    posLo, posHi, velLo, velHi, accLo, accHi[bucketCount]
+// Doubles are little-endian and both sections start on a 64-byte boundary,
+// as in trajectory files.
+
+struct EnvelopeFileHeader {
+    char magic[8];              // "TPIENVL" and a terminating zero
+    std::uint32_t version;
+    std::uint32_t headerSize;
+    std::uint64_t trajectoryCount;
+    std::uint64_t bucketCount;
+    std::uint64_t spanOffset;
+    std::uint64_t recordOffset;
+    std::uint64_t recordSize;
+    std::uint64_t reserved;
+};
+
+static_assert(sizeof(EnvelopeFileHeader) == 64, "EnvelopeFileHeader must be 64 bytes");
+
+const char envelopeFileMagic[8] = {'T', 'P', 'I', 'E', 'N', 'V', 'L', '\0'};
+const std::uint32_t envelopeFileVersion = 1;
+
+// Bucket arrays per record.
+const std::size_t envelopeColumnCount = 6;
+
+// The bucket arrays of one trajectory, bucketCount values each.
+struct EnvelopeRecord {
+    const double* posLo;
+    const double* posHi;
+    const double* velLo;
+    const double* velHi;
+    const double* accLo;
+    const double* accHi;
+};
+
+namespace two_points_interpolation_binary_io_detail {
+
+inline void swapEnvelopeHeader(EnvelopeFileHeader& h) noexcept {
+    h.version = byteSwap(h.version);
+    h.headerSize = byteSwap(h.headerSize);
+    h.trajectoryCount = byteSwap(h.trajectoryCount);
+    h.bucketCount = byteSwap(h.bucketCount);
+    h.spanOffset = byteSwap(h.spanOffset);
+    h.recordOffset = byteSwap(h.recordOffset);
+    h.recordSize = byteSwap(h.recordSize);
+}
+
+inline EnvelopeRecord envelopeRecord(const double* record, const std::size_t bucketCount) noexcept {
+    EnvelopeRecord r = {record, record + bucketCount, record + 2 * bucketCount,
+                        record + 3 * bucketCount, record + 4 * bucketCount, record + 5 * bucketCount};
+    return r;
+}
+
+// Checks everything but the magic, with sizes that cannot overflow for a
+// buffer or file of size bytes.
+inline bool validEnvelopeHeader(const EnvelopeFileHeader& h, const std::uint64_t size) noexcept {
+    const std::uint64_t columnBytes = envelopeColumnCount * sizeof(double);
+    return h.version == envelopeFileVersion && h.headerSize == sizeof(EnvelopeFileHeader)
+        && h.bucketCount > 0 && h.bucketCount <= size / columnBytes
+        && h.recordSize == h.bucketCount * columnBytes
+        && h.trajectoryCount <= size / (2 * sizeof(double))
+        && h.spanOffset % alignof(double) == 0 && h.recordOffset % alignof(double) == 0
+        && h.spanOffset <= size && h.trajectoryCount <= (size - h.spanOffset) / (2 * sizeof(double))
+        && h.recordOffset <= size && h.trajectoryCount <= (size - h.recordOffset) / h.recordSize;
+}
+
+} // namespace two_points_interpolation_binary_io_detail
+
+// Writes the envelopes of count trajectories over bucketCount buckets each,
+// every trajectory over its own [t0, t0 + duration] or, if tEnd > tStart, all
+// over [tStart, tEnd]. Memory use does not depend on count. Returns false if
+// bucketCount is 0 or the file cannot be written.
+inline bool writeEnvelopeFile(const std::string& filePath, const ConstantAccTrajectory* trajectories,
+                              const std::size_t count, const std::size_t bucketCount,
+                              const double tStart = 0, const double tEnd = 0) {
+    namespace detail = two_points_interpolation_binary_io_detail;
+    if (bucketCount == 0) {
+        return false;
+    }
+    std::FILE* file = std::fopen(filePath.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    EnvelopeFileHeader h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, envelopeFileMagic, sizeof(h.magic));
+    h.version = envelopeFileVersion;
+    h.headerSize = sizeof(EnvelopeFileHeader);
+    h.trajectoryCount = count;
+    h.bucketCount = bucketCount;
+    h.spanOffset = detail::alignOffset(sizeof(EnvelopeFileHeader));
+    h.recordOffset = detail::alignOffset(h.spanOffset + 2 * count * sizeof(double));
+    h.recordSize = envelopeColumnCount * bucketCount * sizeof(double);
+    EnvelopeFileHeader stored = h;
+    if (!detail::hostIsLittleEndian()) {
+        detail::swapEnvelopeHeader(stored);
+    }
+
+    const bool common = tEnd > tStart;
+    std::vector<double> spans(2 * count);
+    for (std::size_t j = 0; j < count; ++j) {
+        spans[j] = common ? tStart : trajectories[j].t0;
+        spans[count + j] = common ? tEnd : trajectories[j].t0 + trajectories[j].duration;
+    }
+    bool ok = std::fwrite(&stored, sizeof(stored), 1, file) == 1
+        && detail::pad(file, sizeof(EnvelopeFileHeader), h.spanOffset)
+        && detail::writeDoubles(file, spans.data(), spans.size())
+        && detail::pad(file, h.spanOffset + 2 * count * sizeof(double), h.recordOffset);
+
+    std::vector<double> record(envelopeColumnCount * bucketCount);
+    double* r = record.data();
+    for (std::size_t j = 0; j < count && ok; ++j) {
+        trajectories[j].sampleEnvelope(spans[j], spans[count + j], bucketCount, r, r + bucketCount,
+                                       r + 2 * bucketCount, r + 3 * bucketCount,
+                                       r + 4 * bucketCount, r + 5 * bucketCount);
+        ok = detail::writeDoubles(file, r, record.size());
+    }
+    ok = std::fclose(file) == 0 && ok;
+    return ok;
+}
+
+// Contents of an envelope file loaded into memory.
+struct EnvelopeFileData {
+    EnvelopeFileHeader header;
+    std::vector<double> tStart;
+    std::vector<double> tEnd;
+    std::vector<double> records; // trajectoryCount records back to back
+
+    EnvelopeRecord record(const std::size_t trajectory) const noexcept {
+        const std::size_t bucketCount = static_cast<std::size_t>(header.bucketCount);
+        return two_points_interpolation_binary_io_detail::envelopeRecord(
+            records.data() + trajectory * envelopeColumnCount * bucketCount, bucketCount);
+    }
+};
+
+// Reads a file written by writeEnvelopeFile on hosts of either byte order.
+// Returns false if it cannot be read or is not a supported envelope file.
+inline bool readEnvelopeFile(const std::string& filePath, EnvelopeFileData& out) {
+    namespace detail = two_points_interpolation_binary_io_detail;
+    std::FILE* file = std::fopen(filePath.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    long size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        size = std::ftell(file);
+    }
+    EnvelopeFileHeader& h = out.header;
+    bool ok = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0
+        && std::fread(&h, sizeof(h), 1, file) == 1
+        && std::memcmp(h.magic, envelopeFileMagic, sizeof(h.magic)) == 0;
+    if (ok && !detail::hostIsLittleEndian()) {
+        detail::swapEnvelopeHeader(h);
+    }
+    ok = ok && detail::validEnvelopeHeader(h, static_cast<std::uint64_t>(size));
+
+    const std::size_t count = ok ? static_cast<std::size_t>(h.trajectoryCount) : 0;
+    const std::size_t values = ok ? count * envelopeColumnCount * static_cast<std::size_t>(h.bucketCount) : 0;
+    ok = ok && std::fseek(file, static_cast<long>(h.spanOffset), SEEK_SET) == 0
+        && detail::readDoubles(file, out.tStart, count)
+        && detail::readDoubles(file, out.tEnd, count)
+        && std::fseek(file, static_cast<long>(h.recordOffset), SEEK_SET) == 0
+        && detail::readDoubles(file, out.records, values);
+    std::fclose(file);
+    return ok;
+}
+
+// Zero-copy view of an envelope file already in memory, under the same
+// conditions as TrajectoryFileView.
+struct EnvelopeFileView {
+    const EnvelopeFileHeader* header;
+    const double* tStart;
+    const double* tEnd;
+    const double* records;
+
+    bool parse(const void* data, const std::size_t size) noexcept {
+        namespace detail = two_points_interpolation_binary_io_detail;
+        if (!detail::hostIsLittleEndian() || size < sizeof(EnvelopeFileHeader)
+            || reinterpret_cast<std::uintptr_t>(data) % alignof(double) != 0) {
+            return false;
+        }
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        const EnvelopeFileHeader* h = reinterpret_cast<const EnvelopeFileHeader*>(bytes);
+        if (std::memcmp(h->magic, envelopeFileMagic, sizeof(h->magic)) != 0
+            || !detail::validEnvelopeHeader(*h, size)) {
+            return false;
+        }
+        header = h;
+        tStart = reinterpret_cast<const double*>(bytes + h->spanOffset);
+        tEnd = tStart + h->trajectoryCount;
+        records = reinterpret_cast<const double*>(bytes + h->recordOffset);
+        return true;
+    }
+
+    EnvelopeRecord record(const std::size_t trajectory) const noexcept {
+        const std::size_t bucketCount = static_cast<std::size_t>(header->bucketCount);
+        return two_points_interpolation_binary_io_detail::envelopeRecord(
+            records + trajectory * envelopeColumnCount * bucketCount, bucketCount);
+    }
+};
@@ -1,15 +1,88 @@
-#include <iostream>
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 #include <vector>
 
-inline double vInteg(const double v0, const double a, const double dt) {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+#include <cstdio>
+#endif
+
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_STATS
+#include "two_points_interpolation_constant_acc_stats.hpp"
+#endif
+
+// With C++17 and a way to detect constant evaluation, the solver and the
+// ConstantAccTrajectory queries are constexpr, so fixed profiles can be solved
+// and sampled at compile time (see two_points_interpolation_constant_acc_constexpr.hpp).
+#if defined(__cpp_lib_is_constant_evaluated)
+#define TWO_POINTS_INTERPOLATION_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define TWO_POINTS_INTERPOLATION_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#endif
+
+#if __cplusplus >= 201703L && defined(TWO_POINTS_INTERPOLATION_IS_CONSTANT_EVALUATED)
+#define TWO_POINTS_INTERPOLATION_HAS_CONSTEXPR 1
+#define TWO_POINTS_INTERPOLATION_CONSTEXPR constexpr
+#else
+#define TWO_POINTS_INTERPOLATION_HAS_CONSTEXPR 0
+#define TWO_POINTS_INTERPOLATION_CONSTEXPR inline
+#endif
+
+constexpr double vInteg(const double v0, const double a, const double dt) {
     return v0 + a * dt;
 }
 
-inline double pInteg(const double p0, const double v0, const double a, const double dt) {
+constexpr double pInteg(const double p0, const double v0, const double a, const double dt) {
     return p0 + v0 * dt + 0.5 * a * dt * dt;
 }
 
+// Same integrators for other floating-point types (see
+// BasicTwoPointInterpolation); double and integer arguments keep using the
+// overloads above.
+template <class Scalar, class = typename std::enable_if<std::is_floating_point<Scalar>::value>::type>
+constexpr Scalar vInteg(const Scalar v0, const Scalar a, const Scalar dt) {
+    return v0 + a * dt;
+}
+
+template <class Scalar, class = typename std::enable_if<std::is_floating_point<Scalar>::value>::type>
+constexpr Scalar pInteg(const Scalar p0, const Scalar v0, const Scalar a, const Scalar dt) {
+    return p0 + v0 * dt + Scalar(0.5) * a * dt * dt;
+}
+
+// Square root usable in constant expressions. Newton iteration at compile
+// time (within an ulp of std::sqrt), std::sqrt at run time.
+template <class Scalar>
+TWO_POINTS_INTERPOLATION_CONSTEXPR Scalar constexprSqrt(const Scalar x) noexcept {
+#if TWO_POINTS_INTERPOLATION_HAS_CONSTEXPR
+    if (TWO_POINTS_INTERPOLATION_IS_CONSTANT_EVALUATED()) {
+        if (!(x >= 0)) {
+            return std::numeric_limits<Scalar>::quiet_NaN();
+        }
+        if (x == 0 || x == std::numeric_limits<Scalar>::infinity()) {
+            return x;
+        }
+        Scalar y = x > 1 ? x : Scalar(1);
+        for (;;) {
+            const Scalar next = Scalar(0.5) * (y + x / y);
+            if (next >= y) {
+                return y;
+            }
+            y = next;
+        }
+    }
+#endif
+    return std::sqrt(x);
+}
+
 inline double normalizeAxis(const double input){
     double output = fmod(input + M_PI, 2 * M_PI);
     if (output < 0)
@@ -19,224 +92,1257 @@ inline double normalizeAxis(const double input){
     return output - M_PI;
 }
 
-class TwoPointInterpolation {
+// normalizeAxis for other floating-point types; double and integer arguments
+// use the overload above.
+template <class Scalar, class = typename std::enable_if<std::is_floating_point<Scalar>::value>::type>
+inline Scalar normalizeAxis(const Scalar input){
+    const Scalar pi = static_cast<Scalar>(M_PI);
+    Scalar output = std::fmod(input + pi, 2 * pi);
+    if (output < 0)
+    {
+        output += 2 * pi;
+    }
+    return output - pi;
+}
+
+// Branch-free normalizeAxis for sampling loops; the loop over it vectorizes
+// since it only needs adds, multiplies and selects. The nearest turn count k
+// is rounded with the 1.5 * 2^52 trick and 2 pi is subtracted k times in three
+// parts (Cody-Waite), the first two short enough that k * part is exact.
+// For |input| <= 2^20 * 2 pi (about 6.5e6 rad) the result is within 5e-16
+// of the exact angle, while normalizeAxis rounds input + pi first and is off
+// by up to ulp(input) (about 1e-9 at 6.5e6 rad). Beyond that k * twoPi1 is no
+// longer exact and the error is about ulp(input), like normalizeAxis.
+// Needs strict IEEE double evaluation (no -ffast-math).
+inline double normalizeAxisFast(const double input) noexcept {
+    // decimal forms of 0x1.921fb544p+2, 0x1.0b4611a6p-32, 0x1.3198a2e037073p-67
+    // and 0x1.45f306dc9c883p-3 (hexadecimal floating literals need C++17);
+    // each converts to exactly that double
+    const double twoPi1 = 6.2831853069365025;      // 33 significant bits
+    const double twoPi2 = 2.4308402025215864e-10;  // 33 significant bits
+    const double twoPi3 = 8.0890649951838025e-21;
+    const double invTwoPi = 0.15915494309189535;
+    const double roundMagic = 6755399441055744.0;  // 1.5 * 2^52
+    const double k = (input * invTwoPi + roundMagic) - roundMagic;
+    const double r = ((input - k * twoPi1) - k * twoPi2) - k * twoPi3;
+    // keep the [-pi, pi) range of normalizeAxis
+    const double pi = M_PI;
+    const double upper = r >= pi ? r - 2 * pi : r;
+    return upper < -pi ? upper + 2 * pi : upper;
+}
+
+// Sampled state of a trajectory. Trivially copyable so it can be returned by
+// value or written into caller storage without touching the heap.
+template <class Scalar>
+struct BasicTrajectoryPoint {
+    Scalar pos;
+    Scalar vel;
+    Scalar acc;
+};
+
+typedef BasicTrajectoryPoint<double> TrajectoryPoint;
+
+// Closed interval [lo, hi] of a position or velocity over a time window.
+template <class Scalar>
+struct BasicTrajectoryBounds {
+    Scalar lo;
+    Scalar hi;
+
+    void include(const Scalar value) noexcept {
+        lo = value < lo ? value : lo;
+        hi = value > hi ? value : hi;
+    }
+};
+
+typedef BasicTrajectoryBounds<double> TrajectoryBounds;
+
+// Widens bounds by segment (p, v, a) over local times [sBegin, sEnd]: the
+// values at both ends and, for the position, at the vertex where the
+// velocity crosses zero.
+template <class Scalar>
+inline void widenSegmentBounds(const Scalar p, const Scalar v, const Scalar a,
+                               const Scalar sBegin, const Scalar sEnd, const bool position,
+                               BasicTrajectoryBounds<Scalar>& bounds) noexcept {
+    if (!position) {
+        bounds.include(vInteg(v, a, sBegin));
+        bounds.include(vInteg(v, a, sEnd));
+        return;
+    }
+    bounds.include(pInteg(p, v, a, sBegin));
+    bounds.include(pInteg(p, v, a, sEnd));
+    if (a != 0) {
+        const Scalar sVertex = -v / a;
+        if (sVertex > sBegin && sVertex < sEnd) {
+            bounds.include(pInteg(p, v, a, sVertex));
+        }
+    }
+}
+
+// Solved constant-acceleration profile in segment form. Segment i starts at
+// t0 + segmentStart[i] with velocity v[i] and position p[i] and runs for
+// dt[i] at constant acceleration a[i]. The profile never has more than three
+// segments, so everything is stored inline: no heap, trivially copyable, and
+// aligned to a cache line so it can be handed between threads cheaply.
+template <class Scalar>
+struct alignas(64) BasicConstantAccTrajectory {
+    static const std::size_t maxSegments = 3;
+
+    Scalar t0;
+    Scalar duration;
+    std::size_t segmentCount;
+    std::array<Scalar, maxSegments + 1> segmentStart; // relative to t0; segmentStart[segmentCount] == duration
+    std::array<Scalar, maxSegments> a;
+    std::array<Scalar, maxSegments> v;
+    std::array<Scalar, maxSegments> p;
+    std::array<Scalar, maxSegments> dt;
+    Scalar p0;
+    Scalar v0;
+    Scalar pe;
+    Scalar ve;
+
+    TWO_POINTS_INTERPOLATION_CONSTEXPR void clearSegments() noexcept {
+        segmentCount = 0;
+        segmentStart[0] = 0.0;
+        duration = 0.0;
+    }
+
+    TWO_POINTS_INTERPOLATION_CONSTEXPR void addSegment(const Scalar dtSeg, const Scalar aSeg, const Scalar vSeg, const Scalar pSeg) noexcept {
+        dt[segmentCount] = dtSeg;
+        a[segmentCount] = aSeg;
+        v[segmentCount] = vSeg;
+        p[segmentCount] = pSeg;
+        segmentStart[segmentCount + 1] = segmentStart[segmentCount] + dtSeg;
+        ++segmentCount;
+        duration = segmentStart[segmentCount];
+    }
+
+    TWO_POINTS_INTERPOLATION_CONSTEXPR BasicTrajectoryPoint<Scalar> getState(const Scalar t) const noexcept {
+        Scalar acc = 0;
+        Scalar vel = 0;
+        Scalar pos = 0;
+
+        Scalar tau = t - t0;
+
+        if (tau < 0) {
+            acc = 0.0;
+            vel = v0;
+            pos = p0;
+        } else if (tau >= duration) {
+            acc = 0.0;
+            vel = ve;
+            pos = pe;
+        } else {
+            const std::size_t i = findSegment(tau);
+            const Scalar t_in = tau - segmentStart[i];
+
+            acc = a[i];
+            vel = vInteg(v[i], a[i], t_in);
+            pos = pInteg(p[i], v[i], a[i], t_in);
+        }
+
+        BasicTrajectoryPoint<Scalar> result = {pos, vel, acc};
+        return result;
+    }
+
+    // Number of samples sampleRange() writes for the grid tStart + k * dt < tEnd.
+    static std::size_t sampleCount(const Scalar tStart, const Scalar tEnd, const Scalar dt) noexcept {
+        if (!(dt > 0) || !(tEnd > tStart)) {
+            return 0;
+        }
+        return static_cast<std::size_t>(std::ceil((tEnd - tStart) / dt));
+    }
+
+    // Samples the uniform grid tStart + k * dt < tEnd into caller-provided
+    // buffers of at least sampleCount(tStart, tEnd, dt) elements each. Every
+    // sample matches getState() at the same time; the segments are walked once
+    // and each segment's run is a branch-free polynomial loop.
+    std::size_t sampleRange(const Scalar tStart, const Scalar tEnd, const Scalar dt,
+                            Scalar* time, Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        const std::size_t n = sampleCount(tStart, tEnd, dt);
+        sampleGrid(tStart, dt, 0, n, time, pos, vel, acc);
+        return n;
+    }
+
+    // Samples grid points kBegin <= k < kEnd of tStart + k * dt into buffers of
+    // kEnd - kBegin elements, sample k going to index k - kBegin. Consecutive
+    // windows give exactly the samples of a single sampleRange() call.
+    void sampleGrid(const Scalar tStart, const Scalar dt,
+                    const std::size_t kBegin, const std::size_t kEnd,
+                    Scalar* time, Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        std::size_t k = kBegin;
+
+        std::size_t kRun = gridAdvance(k, kEnd, tStart, dt, 0.0, false);
+        for (std::size_t j = k; j < kRun; ++j) {
+            time[j - kBegin] = tStart + static_cast<Scalar>(j) * dt;
+            pos[j - kBegin] = p0;
+            vel[j - kBegin] = v0;
+            acc[j - kBegin] = 0.0;
+        }
+        k = kRun;
+
+        for (std::size_t i = 0; i < segmentCount && k < kEnd; ++i) {
+            const bool last = i + 1 == segmentCount;
+            kRun = gridAdvance(k, kEnd, tStart, dt, segmentStart[i + 1], !last);
+            const Scalar aSeg = a[i];
+            const Scalar vSeg = v[i];
+            const Scalar pSeg = p[i];
+            const Scalar sSeg = segmentStart[i];
+            for (std::size_t j = k; j < kRun; ++j) {
+                const Scalar t = tStart + static_cast<Scalar>(j) * dt;
+                const Scalar t_in = (t - t0) - sSeg;
+                time[j - kBegin] = t;
+                pos[j - kBegin] = pInteg(pSeg, vSeg, aSeg, t_in);
+                vel[j - kBegin] = vInteg(vSeg, aSeg, t_in);
+                acc[j - kBegin] = aSeg;
+            }
+            k = kRun;
+        }
+
+        for (std::size_t j = k; j < kEnd; ++j) {
+            time[j - kBegin] = tStart + static_cast<Scalar>(j) * dt;
+            pos[j - kBegin] = pe;
+            vel[j - kBegin] = ve;
+            acc[j - kBegin] = 0.0;
+        }
+    }
+
+    // Samples count times sorted in ascending order into pos/vel/acc.
+    void sampleTimes(const Scalar* times, const std::size_t count,
+                     Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        const Scalar tOrigin = t0;
+        const Scalar* first = times;
+        const Scalar* last = times + count;
+
+        const Scalar* end = std::partition_point(first, last,
+            [tOrigin](const Scalar t) { return t - tOrigin < 0; });
+        for (const Scalar* it = first; it != end; ++it) {
+            const std::size_t j = static_cast<std::size_t>(it - times);
+            pos[j] = p0;
+            vel[j] = v0;
+            acc[j] = 0.0;
+        }
+        first = end;
+
+        for (std::size_t i = 0; i < segmentCount; ++i) {
+            const Scalar bound = segmentStart[i + 1];
+            if (i + 1 == segmentCount) {
+                end = std::partition_point(first, last,
+                    [tOrigin, bound](const Scalar t) { return t - tOrigin < bound; });
+            } else {
+                end = std::partition_point(first, last,
+                    [tOrigin, bound](const Scalar t) { return t - tOrigin <= bound; });
+            }
+            const Scalar aSeg = a[i];
+            const Scalar vSeg = v[i];
+            const Scalar pSeg = p[i];
+            const Scalar sSeg = segmentStart[i];
+            const std::size_t jBegin = static_cast<std::size_t>(first - times);
+            const std::size_t jEnd = static_cast<std::size_t>(end - times);
+            for (std::size_t j = jBegin; j < jEnd; ++j) {
+                const Scalar t_in = (times[j] - tOrigin) - sSeg;
+                pos[j] = pInteg(pSeg, vSeg, aSeg, t_in);
+                vel[j] = vInteg(vSeg, aSeg, t_in);
+                acc[j] = aSeg;
+            }
+            first = end;
+        }
+
+        for (const Scalar* it = first; it != last; ++it) {
+            const std::size_t j = static_cast<std::size_t>(it - times);
+            pos[j] = pe;
+            vel[j] = ve;
+            acc[j] = 0.0;
+        }
+    }
+
+    // Index of the segment containing tau, for 0 <= tau < duration. A time
+    // exactly on a boundary belongs to the earlier segment.
+    TWO_POINTS_INTERPOLATION_CONSTEXPR std::size_t findSegment(const Scalar tau) const noexcept {
+        // binary search for the first segment end >= tau
+        std::size_t lo = 1;
+        std::size_t hi = segmentCount + 1;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (segmentStart[mid] < tau) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo - 1;
+    }
+
+    // Earliest time t >= tFrom in [t0, t0 + duration] at which the position
+    // is pos, solved per segment in closed form. Returns false if the profile
+    // does not reach pos there. A position held at max(tFrom, t0) itself is
+    // found there. Roots within a few ulps of a segment boundary
+    // are clamped onto it, and pe itself is always found at the end time,
+    // where getState() switches to it, even when rounding keeps the last
+    // parabola from touching it.
+    bool timeAtPosition(const Scalar pos, Scalar& t,
+                        const Scalar tFrom = -std::numeric_limits<Scalar>::infinity()) const noexcept {
+        const Scalar tStart = searchStart(tFrom);
+        if (tStart <= t0 + duration && getState(tStart).pos == pos) {
+            t = tStart;
+            return true;
+        }
+        for (std::size_t i = 0; i < segmentCount; ++i) {
+            Scalar sLo = 0;
+            Scalar sHi = 0;
+            if (!segmentWindow(i, tFrom, sLo, sHi)) {
+                continue;
+            }
+            const Scalar c = p[i] - pos; // 0.5 a s^2 + v s + c = 0
+            Scalar roots[2];
+            std::size_t rootCount = 0;
+            if (a[i] == 0) {
+                if (v[i] != 0) {
+                    roots[rootCount++] = -c / v[i];
+                } else if (c == 0) {
+                    roots[rootCount++] = sLo;
+                }
+            } else {
+                Scalar disc = v[i] * v[i] - 2 * a[i] * c;
+                // rounding of c grows with the positions, not with c itself
+                const Scalar scale = v[i] * v[i] + 2 * std::fabs(a[i]) * (std::fabs(p[i]) + std::fabs(pos));
+                if (disc < 0 && disc >= -16 * std::numeric_limits<Scalar>::epsilon() * scale) {
+                    disc = 0; // touches pos at the vertex
+                }
+                if (disc >= 0) {
+                    // numerically stable pair of roots
+                    const Scalar q = -Scalar(0.5) * (v[i] + (v[i] < 0 ? -std::sqrt(disc) : std::sqrt(disc)));
+                    const Scalar r0 = q / (Scalar(0.5) * a[i]);
+                    roots[rootCount++] = r0;
+                    if (q != 0) {
+                        const Scalar r1 = c / q;
+                        roots[rootCount++] = r1;
+                        if (r1 < r0) {
+                            roots[0] = r1;
+                            roots[1] = r0;
+                        }
+                    }
+                }
+            }
+            // a root the rounding pushes just outside the window, where the
+            // position at the window edge is already pos, is taken there
+            const Scalar positionSlack = 8 * std::numeric_limits<Scalar>::epsilon()
+                * (std::fabs(p[i]) + std::fabs(pos) + std::fabs(v[i]) * sHi + std::fabs(a[i]) * sHi * sHi);
+            for (std::size_t r = 0; r < rootCount; ++r) {
+                const Scalar edge = roots[r] < sLo ? sLo : (roots[r] > sHi ? sHi : roots[r]);
+                if (edge != roots[r] && std::fabs(pInteg(p[i], v[i], a[i], edge) - pos) <= positionSlack) {
+                    roots[r] = edge;
+                }
+                if (acceptRoot(i, roots[r], sLo, sHi, tFrom, t)) {
+                    return true;
+                }
+            }
+        }
+        return reachesAtEnd(pos == pe, tFrom, t);
+    }
+
+    // Earliest time t >= tFrom in [t0, t0 + duration] at which the velocity
+    // is vel; see timeAtPosition.
+    bool timeAtVelocity(const Scalar vel, Scalar& t,
+                        const Scalar tFrom = -std::numeric_limits<Scalar>::infinity()) const noexcept {
+        const Scalar tStart = searchStart(tFrom);
+        if (tStart <= t0 + duration && getState(tStart).vel == vel) {
+            t = tStart;
+            return true;
+        }
+        for (std::size_t i = 0; i < segmentCount; ++i) {
+            Scalar sLo = 0;
+            Scalar sHi = 0;
+            if (!segmentWindow(i, tFrom, sLo, sHi)) {
+                continue;
+            }
+            if (a[i] == 0) {
+                if (v[i] == vel && acceptRoot(i, sLo, sLo, sHi, tFrom, t)) {
+                    return true;
+                }
+            } else if (acceptRoot(i, (vel - v[i]) / a[i], sLo, sHi, tFrom, t)) {
+                return true;
+            }
+        }
+        return reachesAtEnd(vel == ve, tFrom, t);
+    }
+
+    // Range of the position over [tBegin, tEnd], including the held states
+    // before t0 and after the end, from the segment ends and vertices in the
+    // window (O(segments), exact up to rounding). tEnd <= tBegin gives the
+    // position at tBegin.
+    BasicTrajectoryBounds<Scalar> positionBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        return bounds(tBegin, tEnd, true);
+    }
+
+    // Range of the velocity over [tBegin, tEnd]; see positionBounds.
+    BasicTrajectoryBounds<Scalar> velocityBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        return bounds(tBegin, tEnd, false);
+    }
+
+    // Range of the acceleration over [tBegin, tEnd]: the accelerations of the
+    // segments the window overlaps, and 0 where it reaches past either end.
+    BasicTrajectoryBounds<Scalar> accelerationBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        BasicTrajectoryBounds<Scalar> result;
+        const BasicTrajectoryPoint<Scalar> first = getState(tBegin);
+        windowBounds(tBegin, tEnd, first, tEnd > tBegin ? getState(tEnd) : first, nullptr, nullptr, &result);
+        return result;
+    }
+
+    // Min/max envelope over bucketCount equal buckets of [tStart, tEnd], for
+    // drawing long or many profiles at screen resolution: bucket k holds the
+    // ranges over [tStart + k * w, tStart + (k + 1) * w], w = (tEnd - tStart)
+    // / bucketCount, exactly as positionBounds(), velocityBounds() and
+    // accelerationBounds() give them, so no peak between samples is lost.
+    // Each non-null output receives bucketCount values.
+    void sampleEnvelope(const Scalar tStart, const Scalar tEnd, const std::size_t bucketCount,
+                        Scalar* posLo, Scalar* posHi, Scalar* velLo, Scalar* velHi,
+                        Scalar* accLo, Scalar* accHi) const noexcept {
+        const Scalar width = (tEnd - tStart) / static_cast<Scalar>(bucketCount);
+        Scalar tBegin = tStart;
+        BasicTrajectoryPoint<Scalar> first = getState(tBegin);
+        for (std::size_t k = 0; k < bucketCount; ++k) {
+            // the state at each inner edge is shared by both buckets
+            const Scalar tFinish = k + 1 == bucketCount ? tEnd : tStart + static_cast<Scalar>(k + 1) * width;
+            const BasicTrajectoryPoint<Scalar> last = tFinish > tBegin ? getState(tFinish) : first;
+            BasicTrajectoryBounds<Scalar> pos;
+            BasicTrajectoryBounds<Scalar> vel;
+            BasicTrajectoryBounds<Scalar> acc;
+            windowBounds(tBegin, tFinish, first, last, posLo || posHi ? &pos : nullptr,
+                         velLo || velHi ? &vel : nullptr, accLo || accHi ? &acc : nullptr);
+            if (posLo) {
+                posLo[k] = pos.lo;
+            }
+            if (posHi) {
+                posHi[k] = pos.hi;
+            }
+            if (velLo) {
+                velLo[k] = vel.lo;
+            }
+            if (velHi) {
+                velHi[k] = vel.hi;
+            }
+            if (accLo) {
+                accLo[k] = acc.lo;
+            }
+            if (accHi) {
+                accHi[k] = acc.hi;
+            }
+            tBegin = tFinish;
+            first = last;
+        }
+    }
+
+private:
+    // Part [sLo, sHi] of segment i, in segment-local time, that lies at or
+    // after both t0 and tFrom; false if there is none. Only a profile with a
+    // negative phase has segments starting before t0.
+    bool segmentWindow(const std::size_t i, const Scalar tFrom, Scalar& sLo, Scalar& sHi) const noexcept {
+        sHi = dt[i];
+        const Scalar tauFrom = tFrom - t0;
+        const Scalar from = (tauFrom > 0 ? tauFrom : Scalar(0)) - segmentStart[i];
+        sLo = from > 0 ? from : Scalar(0);
+        return sLo <= sHi;
+    }
+
+    BasicTrajectoryBounds<Scalar> bounds(const Scalar tBegin, const Scalar tEnd, const bool position) const noexcept {
+        BasicTrajectoryBounds<Scalar> result;
+        const BasicTrajectoryPoint<Scalar> first = getState(tBegin);
+        windowBounds(tBegin, tEnd, first, tEnd > tBegin ? getState(tEnd) : first,
+                     position ? &result : nullptr, position ? nullptr : &result, nullptr);
+        return result;
+    }
+
+    // Ranges over [tBegin, tEnd] into the non-null outputs, given the states
+    // at both ends of the window.
+    void windowBounds(const Scalar tBegin, const Scalar tEnd,
+                      const BasicTrajectoryPoint<Scalar>& first, const BasicTrajectoryPoint<Scalar>& last,
+                      BasicTrajectoryBounds<Scalar>* position, BasicTrajectoryBounds<Scalar>* velocity,
+                      BasicTrajectoryBounds<Scalar>* acceleration) const noexcept {
+        if (position) {
+            position->lo = position->hi = first.pos;
+        }
+        if (velocity) {
+            velocity->lo = velocity->hi = first.vel;
+        }
+        if (acceleration) {
+            acceleration->lo = acceleration->hi = first.acc;
+        }
+        if (!(tEnd > tBegin)) {
+            return;
+        }
+        if (position) {
+            position->include(last.pos);
+        }
+        if (velocity) {
+            velocity->include(last.vel);
+        }
+        if (acceleration) {
+            acceleration->include(last.acc);
+        }
+        const Scalar tauBegin = tBegin - t0;
+        const Scalar tauEnd = tEnd - t0;
+        for (std::size_t i = 0; i < segmentCount; ++i) {
+            const Scalar start = segmentStart[i];
+            const Scalar end = segmentStart[i + 1];
+            const Scalar sBegin = (tauBegin > start ? tauBegin : start) - start;
+            const Scalar sEnd = (tauEnd < end ? tauEnd : end) - start;
+            if (sBegin <= sEnd) {
+                if (position) {
+                    widenSegmentBounds(p[i], v[i], a[i], sBegin, sEnd, true, *position);
+                }
+                if (velocity) {
+                    widenSegmentBounds(p[i], v[i], a[i], sBegin, sEnd, false, *velocity);
+                }
+                // a window only touching the start of a segment (which
+                // getState() gives to the previous one) does not reach it
+                if (acceleration && sBegin < sEnd) {
+                    acceleration->include(a[i]);
+                }
+            }
+        }
+    }
+
+    // First time a search from tFrom looks at, max(tFrom, t0); NaN, which
+    // fails every comparison, if there is no profile.
+    Scalar searchStart(const Scalar tFrom) const noexcept {
+        if (segmentCount == 0) {
+            return std::numeric_limits<Scalar>::quiet_NaN();
+        }
+        return tFrom > t0 ? tFrom : t0;
+    }
+
+    bool reachesAtEnd(const bool endMatches, const Scalar tFrom, Scalar& t) const noexcept {
+        const Scalar tEnd = t0 + duration;
+        if (segmentCount == 0 || !endMatches || !(tFrom <= tEnd)) {
+            return false;
+        }
+        t = tEnd;
+        return true;
+    }
+
+    // Accepts root s of segment i if it lies in [sLo, sHi] up to rounding and
+    // writes its absolute time, clamped into the window, to tFrom and to
+    // [t0, t0 + duration]. On a profile with a negative phase, segments
+    // overlap in time, so the root must also lie where getState() evaluates
+    // segment i (or on a boundary it shares with a neighbour), which excludes
+    // the end time itself.
+    bool acceptRoot(const std::size_t i, Scalar s, const Scalar sLo, const Scalar sHi,
+                    const Scalar tFrom, Scalar& t) const noexcept {
+        const Scalar slack = 64 * std::numeric_limits<Scalar>::epsilon() * (sHi > 1 ? sHi : Scalar(1));
+        if (!(s >= sLo - slack && s <= sHi + slack)) {
+            return false;
+        }
+        s = s < sLo ? sLo : (s > sHi ? sHi : s);
+        Scalar root = t0 + segmentStart[i] + s;
+        const Scalar tEnd = t0 + duration;
+        const Scalar tMagnitude = std::fabs(t0) > std::fabs(tEnd) ? std::fabs(t0) : std::fabs(tEnd);
+        const Scalar timeSlack = slack + 4 * std::numeric_limits<Scalar>::epsilon() * tMagnitude;
+        if (!(root >= t0 - timeSlack && root <= tEnd + timeSlack)) {
+            return false;
+        }
+        root = root < t0 ? t0 : (root > tEnd ? tEnd : root);
+        root = root < tFrom ? tFrom : root;
+        bool monotone = true;
+        for (std::size_t k = 0; k < segmentCount; ++k) {
+            monotone = monotone && dt[k] >= 0;
+        }
+        if (!monotone) {
+            // getState() jumps to (pe, ve) at the end time, so a root rounded
+            // onto it moves to the last time before the jump
+            for (int step = 0; step < 4 && root - t0 >= duration; ++step) {
+                root = std::nextafter(root, -std::numeric_limits<Scalar>::infinity());
+            }
+            if (root - t0 >= duration || root < t0 || root < tFrom) {
+                return false;
+            }
+            // a neighbour may own a root on their shared boundary
+            const std::size_t owner = findSegment(root - t0);
+            const Scalar start = t0 + segmentStart[i];
+            const bool atStart = owner + 1 == i && std::fabs(root - start) <= timeSlack;
+            const bool atEnd = owner == i + 1 && std::fabs(root - (start + dt[i])) <= timeSlack;
+            if (owner != i && !atStart && !atEnd) {
+                return false;
+            }
+        }
+        t = root;
+        return true;
+    }
+
+    // First grid index in [k, n) whose relative time tau = tStart + j * dt - t0
+    // no longer satisfies tau <= limit (inclusive) or tau < limit, or n. The
+    // index is estimated directly and then corrected so that the split is
+    // exactly the one getState() would make.
+    std::size_t gridAdvance(const std::size_t k, const std::size_t n,
+                            const Scalar tStart, const Scalar dt,
+                            const Scalar limit, const bool inclusive) const noexcept {
+        const Scalar estimate = std::ceil((limit + t0 - tStart) / dt);
+        std::size_t j = k;
+        if (estimate > static_cast<Scalar>(n)) {
+            j = n;
+        } else if (estimate > static_cast<Scalar>(k)) {
+            j = static_cast<std::size_t>(estimate);
+        }
+        while (j > k && gridBeyond(j - 1, tStart, dt, limit, inclusive)) {
+            --j;
+        }
+        while (j < n && !gridBeyond(j, tStart, dt, limit, inclusive)) {
+            ++j;
+        }
+        return j;
+    }
+
+    bool gridBeyond(const std::size_t j, const Scalar tStart, const Scalar dt,
+                    const Scalar limit, const bool inclusive) const noexcept {
+        const Scalar tau = (tStart + static_cast<Scalar>(j) * dt) - t0;
+        return inclusive ? !(tau <= limit) : !(tau < limit);
+    }
+};
+
+template <class Scalar>
+const std::size_t BasicConstantAccTrajectory<Scalar>::maxSegments;
+
+typedef BasicConstantAccTrajectory<double> ConstantAccTrajectory;
+
+// Streams a trajectory at monotonically increasing times. The cursor keeps
+// the current segment, so step() needs no search: inside a segment it
+// advances the state incrementally (p += v * dt + a * dt^2 / 2, v += a * dt)
+// and re-evaluates it exactly from the segment start every resyncInterval
+// steps and whenever a segment boundary is crossed, which bounds the
+// accumulated rounding drift. The trajectory is copied, so the cursor stays
+// valid when the planner replans.
+template <class Scalar>
+class BasicTrajectoryCursor {
+private:
+    BasicConstantAccTrajectory<Scalar> _trajectory;
+    Scalar _t;
+    std::size_t _region; // 0: before t0, i + 1: segment i, segmentCount + 1: after the end
+    BasicTrajectoryPoint<Scalar> _state;
+    unsigned _resyncInterval;
+    unsigned _stepsSinceSync;
+
+public:
+    static const unsigned defaultResyncInterval = 64;
+
+    BasicTrajectoryCursor(const BasicConstantAccTrajectory<Scalar>& trajectory, const Scalar t,
+                          const unsigned resyncInterval = defaultResyncInterval) noexcept
+        : _trajectory(trajectory), _t(t), _region(0),
+          _resyncInterval(resyncInterval > 0 ? resyncInterval : 1), _stepsSinceSync(0) {
+        seek(t);
+    }
+
+    Scalar time() const noexcept {
+        return _t;
+    }
+
+    const BasicTrajectoryPoint<Scalar>& state() const noexcept {
+        return _state;
+    }
+
+    // Jumps to an arbitrary time t (forward or backward) with an exact evaluation.
+    const BasicTrajectoryPoint<Scalar>& seek(const Scalar t) noexcept {
+        _t = t;
+        _region = 0;
+        advanceRegion(_t - _trajectory.t0);
+        resync();
+        return _state;
+    }
+
+    // Advances by dt >= 0 and returns the state at the new time. A negative
+    // dt falls back to seek().
+    const BasicTrajectoryPoint<Scalar>& step(const Scalar dt) noexcept {
+        if (dt < 0) {
+            return seek(_t + dt);
+        }
+        const Scalar tPrevious = _t;
+        _t += dt;
+        // the step actually taken: t + dt rounds, notably in float far from 0
+        const Scalar h = _t - tPrevious;
+        const Scalar tau = _t - _trajectory.t0;
+        if (!contains(_region, tau)) {
+            advanceRegion(tau);
+            resync();
+        } else if (_region == 0 || _region > _trajectory.segmentCount) {
+            // holding the boundary state
+        } else if (++_stepsSinceSync >= _resyncInterval) {
+            resync();
+        } else {
+            _state.pos += _state.vel * h + Scalar(0.5) * _state.acc * h * h;
+            _state.vel += _state.acc * h;
+        }
+        return _state;
+    }
+
+private:
+    bool contains(const std::size_t region, const Scalar tau) const noexcept {
+        const std::size_t n = _trajectory.segmentCount;
+        if (region == 0) {
+            return tau < 0;
+        }
+        if (region > n) {
+            return tau >= _trajectory.duration;
+        }
+        if (region == n) {
+            return tau < _trajectory.duration;
+        }
+        return tau <= _trajectory.segmentStart[region];
+    }
+
+    void advanceRegion(const Scalar tau) noexcept {
+        while (!contains(_region, tau) && _region <= _trajectory.segmentCount) {
+            ++_region;
+        }
+    }
+
+    void resync() noexcept {
+        _stepsSinceSync = 0;
+        const Scalar tau = _t - _trajectory.t0;
+        if (_region == 0) {
+            _state.pos = _trajectory.p0;
+            _state.vel = _trajectory.v0;
+            _state.acc = 0.0;
+        } else if (_region > _trajectory.segmentCount) {
+            _state.pos = _trajectory.pe;
+            _state.vel = _trajectory.ve;
+            _state.acc = 0.0;
+        } else {
+            const std::size_t i = _region - 1;
+            const Scalar t_in = tau - _trajectory.segmentStart[i];
+            _state.pos = pInteg(_trajectory.p[i], _trajectory.v[i], _trajectory.a[i], t_in);
+            _state.vel = vInteg(_trajectory.v[i], _trajectory.a[i], t_in);
+            _state.acc = _trajectory.a[i];
+        }
+    }
+};
+
+template <class Scalar>
+const unsigned BasicTrajectoryCursor<Scalar>::defaultResyncInterval;
+
+typedef BasicTrajectoryCursor<double> TrajectoryCursor;
+
+// Receives calcTrajectory diagnostics: a label ("case", "dt", "a", "v", "p",
+// or an error message) followed by count values.
+typedef void (*TwoPointInterpolationTraceCallback)(void* user, const char* label,
+                                                   const double* values, std::size_t count);
+
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+// Default trace sink: prints "label v0 v1 ...", one line per call.
+inline void printTwoPointInterpolationTrace(void* /*user*/, const char* label,
+                                            const double* values, const std::size_t count) {
+    std::printf("%s", label);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::printf(" %g", values[i]);
+    }
+    std::printf("\n");
+}
+#endif
+
+// Solves the minimum-time profile from the boundary state already stored in
+// trajectory (t0, p0, v0, pe, ve) and fills its segments. Returns the case
+// number (0: vmax not reached, 1: coasts at vmax) and the signed acceleration
+// of the first segment, or -1 when there is no solution.
+template <class Scalar>
+TWO_POINTS_INTERPOLATION_CONSTEXPR int solveConstantAccTrajectory(BasicConstantAccTrajectory<Scalar>& trajectory,
+                                                                  const Scalar amax, const Scalar vmax,
+                                                                  Scalar& aSigned) noexcept {
+    const Scalar p0 = trajectory.p0;
+    const Scalar v0 = trajectory.v0;
+    const Scalar pe = trajectory.pe;
+    const Scalar ve = trajectory.ve;
+    const Scalar dp = pe - p0;
+    const Scalar dv = ve - v0;
+    const Scalar dpAbs = dp < 0 ? -dp : dp;
+
+    trajectory.clearSegments();
+
+    aSigned = amax * dp / dpAbs;
+    const Scalar b = v0 / aSigned;
+    const Scalar c = (-dv * (ve + v0) * Scalar(0.5) / aSigned - dp) / aSigned;
+    if (!(b * b - c > 0)) {
+        return -1;
+    }
+
+    Scalar dt01 = -b + constexprSqrt(b * b - c);
+    Scalar v1 = vInteg(v0, aSigned, dt01);
+    if ((v1 < 0 ? -v1 : v1) < vmax) { // not reach the vmax
+        const Scalar p1 = pInteg(p0, v0, aSigned, dt01);
+        const Scalar dt1e = dt01 - dv / aSigned;
+        trajectory.addSegment(dt01, aSigned, v0, p0);
+        trajectory.addSegment(dt1e, -aSigned, v1, p1);
+        return 0;
+    }
+
+    v1 = vmax * dp / dpAbs;
+    dt01 = (v1 - v0) / aSigned;
+    const Scalar p1 = pInteg(p0, v0, aSigned, dt01);
+    trajectory.addSegment(dt01, aSigned, v0, p0);
+    const Scalar v2 = v1;
+    const Scalar dt2e = (ve - v2) / -aSigned;
+    const Scalar dp2e = pInteg(Scalar(0), v2, -aSigned, dt2e);
+    const Scalar dt12 = (pe - p1 - dp2e) / v1;
+    const Scalar p2 = pe - dp2e;
+    trajectory.addSegment(dt12, Scalar(0), v1, p1);
+    trajectory.addSegment(dt2e, -aSigned, v2, p2);
+    return 1;
+}
+
+// Duration of the profile solveConstantAccTrajectory() would produce, without
+// building it: the same arithmetic with no segment storage, so the result is
+// bit-identical to TwoPointInterpolation::calcTrajectory(). Cheap enough for
+// cost heuristics in search-based planners. Returns -1 if there is no
+// solution; caseNum, if given, receives 0, 1 or -1.
+TWO_POINTS_INTERPOLATION_CONSTEXPR double minimumDuration(const double p0, const double pe,
+                                                          const double amax, const double vmax,
+                                                          const double v0 = 0, const double ve = 0,
+                                                          int* caseNum = nullptr) noexcept {
+    const double dp = pe - p0;
+    const double dv = ve - v0;
+    const double dpAbs = dp < 0 ? -dp : dp;
+    int result = -1;
+    double duration = -1;
+    if (dpAbs > 0) {
+        const double aSigned = amax * dp / dpAbs;
+        const double b = v0 / aSigned;
+        const double c = (-dv * (ve + v0) * 0.5 / aSigned - dp) / aSigned;
+        if (b * b - c > 0) {
+            const double dt01 = -b + constexprSqrt(b * b - c);
+            const double v1 = vInteg(v0, aSigned, dt01);
+            if ((v1 < 0 ? -v1 : v1) < vmax) {
+                duration = (0.0 + dt01) + (dt01 - dv / aSigned);
+                result = 0;
+            } else {
+                const double vc = vmax * dp / dpAbs;
+                const double dtAcc = (vc - v0) / aSigned;
+                const double dtDec = (ve - vc) / -aSigned;
+                const double dpDec = pInteg(0, vc, -aSigned, dtDec);
+                const double dtCoast = (pe - pInteg(p0, v0, aSigned, dtAcc) - dpDec) / vc;
+                duration = ((0.0 + dtAcc) + dtCoast) + dtDec;
+                result = 1;
+            }
+        }
+    }
+    if (caseNum) {
+        *caseNum = result;
+    }
+    return duration;
+}
+
+// True if a profile from (p0, v0) to (pe, ve) exists under the constraints,
+// i.e. minimumDuration() would not return -1. Only the acceleration limit
+// decides this; vmax is accepted so both functions take the same arguments.
+TWO_POINTS_INTERPOLATION_CONSTEXPR bool isFeasible(const double p0, const double pe,
+                                                   const double amax, const double vmax,
+                                                   const double v0 = 0, const double ve = 0) noexcept {
+    static_cast<void>(vmax);
+    const double dp = pe - p0;
+    const double dpAbs = dp < 0 ? -dp : dp;
+    if (!(dpAbs > 0)) {
+        return false;
+    }
+    const double aSigned = amax * dp / dpAbs;
+    const double b = v0 / aSigned;
+    const double c = (-(ve - v0) * (ve + v0) * 0.5 / aSigned - dp) / aSigned;
+    return b * b - c > 0;
+}
+
+// Solves a profile from scratch; usable in constant expressions with C++17.
+TWO_POINTS_INTERPOLATION_CONSTEXPR ConstantAccTrajectory makeConstantAccTrajectory(
+        const double p0, const double pe,
+        const double amax, const double vmax,
+        const double t0 = 0, const double v0 = 0,
+        const double ve = 0) noexcept {
+    ConstantAccTrajectory trajectory{};
+    trajectory.t0 = t0;
+    trajectory.p0 = p0;
+    trajectory.v0 = v0;
+    trajectory.pe = pe;
+    trajectory.ve = ve;
+    double aSigned = 0.0;
+    solveConstantAccTrajectory(trajectory, amax, vmax, aSigned);
+    return trajectory;
+}
+
+// First revision() of a new planner: every planner gets its own range of
+// 2^32 revisions, so two planners, or two planners built one after the other
+// at the same address, do not share revision numbers.
+inline std::uint64_t nextTwoPointInterpolationRevisionBase() noexcept {
+    static std::atomic<std::uint64_t> planners(0);
+    return planners.fetch_add(1, std::memory_order_relaxed) << 32;
+}
+
+// Planner for one axis. Scalar is the floating-point type of the solver
+// and sampler (double or float); TwoPointInterpolation is the double version
+// used throughout; the cursor, cache and publisher helpers work with it.
+template <class Scalar>
+class BasicTwoPointInterpolation {
 private:
     bool _pointSetted;
     bool _constraintsSetted;
     bool _initialStateSetted;
     bool _trajectoryCalced;
     bool _verbose;
+    TwoPointInterpolationTraceCallback _traceCallback;
+    void* _traceUser;
 
-    double _t0;
-    double _p0;
-    double _v0;
-    double _pe;
-    double _ve;
-    double _amax;
-    double _vmax;
-    std::vector<double> _dt;
-    std::vector<double> _a;
-    std::vector<double> _v;
-    std::vector<double> _p;
-    double _aSigned;
+    Scalar _amax;
+    Scalar _vmax;
+    Scalar _aSigned;
     int _caseNum;
+    std::uint64_t _revision;
+    BasicConstantAccTrajectory<Scalar> _trajectory; // also holds the boundary state t0, p0, v0, pe, ve
 
 public:
-    TwoPointInterpolation(const bool verbose = false) {
+    BasicTwoPointInterpolation(const bool verbose = false) {
         _pointSetted = false;
         _constraintsSetted = false;
         _initialStateSetted = false;
         _trajectoryCalced = false;
         _verbose = verbose;
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+        _traceCallback = printTwoPointInterpolationTrace;
+#else
+        _traceCallback = nullptr;
+#endif
+        _traceUser = nullptr;
+        _amax = 0;
+        _vmax = 0;
+        _revision = nextTwoPointInterpolationRevisionBase();
+        _trajectory = BasicConstantAccTrajectory<Scalar>();
+        _trajectory.clearSegments();
     }
 
-    void setInitial(const double t0, const double p0, const double v0 = 0) {
-        _t0 = t0;
-        _p0 = p0;
-        _v0 = v0;
+    void setInitial(const Scalar t0, const Scalar p0, const Scalar v0 = 0) {
+        _trajectory.t0 = t0;
+        _trajectory.p0 = p0;
+        _trajectory.v0 = v0;
         _initialStateSetted = true;
+        ++_revision;
     }
 
-    void setPoint(const double pe, const double ve = 0) {
-        _pe = pe;
-        _ve = ve;
+    void setPoint(const Scalar pe, const Scalar ve = 0) {
+        _trajectory.pe = pe;
+        _trajectory.ve = ve;
         _pointSetted = true;
+        ++_revision;
     }
 
-    void setConstraints(const double amax, const double vmax) {
+    void setConstraints(const Scalar amax, const Scalar vmax) {
         _amax = amax;
         _vmax = vmax;
         _constraintsSetted = true;
+        ++_revision;
     }
 
-    bool isInitialized()
+    // Routes verbose diagnostics to callback (null disables them). Tracing is
+    // compiled in only when TWO_POINTS_INTERPOLATION_ENABLE_TRACE is defined;
+    // otherwise calcTrajectory carries no diagnostic code at all.
+    void setTraceCallback(const TwoPointInterpolationTraceCallback callback, void* user = nullptr) {
+        _traceCallback = callback;
+        _traceUser = user;
+    }
+
+    bool isInitialized() const
     {
         return _pointSetted && _constraintsSetted && _initialStateSetted && _trajectoryCalced;
     }
 
-    void init(const double p0, const double pe, 
-              const double amax, const double vmax, 
-              const double t0 = 0, const double v0 = 0, 
-              const double ve = 0) {
+    void init(const Scalar p0, const Scalar pe, 
+              const Scalar amax, const Scalar vmax, 
+              const Scalar t0 = 0, const Scalar v0 = 0, 
+              const Scalar ve = 0) {
         setInitial(t0, p0, v0);
         setPoint(pe, ve);
         setConstraints(amax, vmax);
     }
 
-    double calcTrajectory() {
-        double dp = _pe - _p0;
-        double dv = _ve - _v0;
-
-        _dt.clear();
-        _a.clear();
-        _v.clear();
-        _p.clear();
-
-        _v.push_back(_v0);
-        _p.push_back(_p0);
-
-        _aSigned = _amax * dp / std::fabs(dp); 
-        double b = _v0 / _aSigned;
-        double c = (-dv * (_ve + _v0) * 0.5 / _aSigned - dp) / _aSigned;
-        if (b * b - c > 0) { 
-            double dt01 = -b + std::sqrt(b * b - c);
-            double v1 = vInteg(_v0, _aSigned, dt01);
-            if (std::fabs(v1) < _vmax) { // not reach the vmax
-                _caseNum = 0;
-                double p1 = pInteg(_p0, _v0, _aSigned, dt01);
-                double dt1e = dt01 - dv / _aSigned;
-                _dt.push_back(dt01);
-                _dt.push_back(dt1e);
-                _a.push_back(_aSigned);
-                _a.push_back(-_aSigned);
-                _v.push_back(v1);
-                _p.push_back(p1);
-            } else {
-                _caseNum = 1;
-                v1 = _vmax * dp / std::fabs(dp);
-                dt01 = (v1 - _v0) / _aSigned;
-                double p1 = pInteg(_p0, _v0, _aSigned, dt01);
-                _dt.push_back(dt01);
-                _a.push_back(_aSigned);
-                _v.push_back(v1);
-                _p.push_back(p1);
-                double v2 = v1;
-                double dt2e = (_ve - v2) / -_aSigned;
-                double dp2e = pInteg(0, v2, -_aSigned, dt2e);
-                double dt12 = (_pe - p1 - dp2e) / v1;
-                double p2 = _pe - dp2e;
-                _dt.push_back(dt12);
-                _dt.push_back(dt2e);
-                _a.push_back(0.0);
-                _a.push_back(-_aSigned);
-                _v.push_back(v2);
-                _p.push_back(p2);
-            }
-        } else {
-            if (_verbose) {
-                std::cout << "TwoPointInterpolation::calcTrajectory error" << std::endl;
+    Scalar calcTrajectory() {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_STATS
+        const TrajectoryStatsScope statsScope(statsCalcTrajectoryTimer);
+        trajectoryStatsCount(statsCalcTrajectory);
+#endif
+        const int caseNum = solveConstantAccTrajectory(_trajectory, _amax, _vmax, _aSigned);
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_STATS
+        trajectoryStatsCount(caseNum < 0 ? statsInfeasible : (caseNum == 0 ? statsCase0 : statsCase1));
+#endif
+        if (caseNum < 0) {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+            if (_verbose && _traceCallback) {
+                _traceCallback(_traceUser, "TwoPointInterpolation::calcTrajectory error", nullptr, 0);
             }
+#endif
             return -1;
         }
+        _caseNum = caseNum;
 
-        if (_verbose) {
-            std::cout << "case " << _caseNum << std::endl;
-            std::cout << "dt ";
-            for (double t : _dt) {
-                std::cout << t << " ";
-            }
-            std::cout << std::endl;
-            std::cout << "a ";
-            for (double acc : _a) {
-                std::cout << acc << " ";
-            }
-            std::cout << std::endl;
-            std::cout << "v ";
-            for (double vel : _v) {
-                std::cout << vel << " ";
-            }
-            std::cout << std::endl;
-            std::cout << "p ";
-            for (double pos : _p) {
-                std::cout << pos << " ";
-            }
-            std::cout << std::endl;
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+        if (_verbose && _traceCallback) {
+            const std::size_t n = _trajectory.segmentCount;
+            const double caseValue = _caseNum;
+            _traceCallback(_traceUser, "case", &caseValue, 1);
+            traceSegments("dt", _trajectory.dt.data(), n);
+            traceSegments("a", _trajectory.a.data(), n);
+            traceSegments("v", _trajectory.v.data(), n);
+            traceSegments("p", _trajectory.p.data(), n);
         }
+#endif
 
         _trajectoryCalced = true;
+        ++_revision;
 
-        double totalDt = 0;
-        for (double t : _dt) {
-            totalDt += t;
-        }
-
-        return totalDt;
+        return _trajectory.duration;
     }
 
-    double calcTrajectory(const double p0, const double pe, 
-                          const double amax, const double vmax, 
-                          const double t0 = 0, const double v0 = 0, 
-                          const double ve = 0) {
+    Scalar calcTrajectory(const Scalar p0, const Scalar pe, 
+                          const Scalar amax, const Scalar vmax, 
+                          const Scalar t0 = 0, const Scalar v0 = 0, 
+                          const Scalar ve = 0) {
         init(p0, pe, amax, vmax, t0, v0, ve);
         return calcTrajectory();
     }
 
-    std::vector<double> getPoint(const double t) const {
-        double a = 0;
-        double v = 0;
-        double pos = 0;
+    // Replans from the state of the current profile at time t towards a new
+    // end point, keeping the constraints. When pe and ve differ from the
+    // current end point by at most tolerance, the profile is left untouched.
+    // Otherwise t becomes the new t0 and only the remaining motion is solved.
+    // Returns the duration of the resulting profile, or -1 if no profile has
+    // been calculated yet or the new one has no solution, including targets
+    // too close to be reached without overshoot (a negative phase); the
+    // previous profile is kept in that case.
+    Scalar replan(const Scalar t, const Scalar pe, const Scalar ve = 0, const Scalar tolerance = 0) {
+        if (!_trajectoryCalced) {
+            return -1;
+        }
+        if (std::fabs(pe - _trajectory.pe) <= tolerance && std::fabs(ve - _trajectory.ve) <= tolerance) {
+            return _trajectory.duration;
+        }
+        const BasicTrajectoryPoint<Scalar> state = _trajectory.getState(t);
+        BasicConstantAccTrajectory<Scalar> next = _trajectory;
+        next.t0 = t;
+        next.p0 = state.pos;
+        next.v0 = state.vel;
+        next.pe = pe;
+        next.ve = ve;
+        Scalar aSigned = 0;
+        const int caseNum = solveConstantAccTrajectory(next, _amax, _vmax, aSigned);
+        bool valid = caseNum >= 0;
+        for (std::size_t i = 0; i < next.segmentCount; ++i) {
+            valid = valid && next.dt[i] >= 0;
+        }
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_STATS
+        trajectoryStatsCount(valid ? statsReplan : statsReplanRejected);
+#endif
+        if (!valid) {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+            if (_verbose && _traceCallback) {
+                _traceCallback(_traceUser, "TwoPointInterpolation::replan error", nullptr, 0);
+            }
+#endif
+            return -1;
+        }
+        _trajectory = next;
+        _aSigned = aSigned;
+        _caseNum = caseNum;
+        ++_revision;
+        return _trajectory.duration;
+    }
 
-        double tau = t - _t0;
+    // Adopts a profile solved elsewhere, for example decoded from a message
+    // (see two_points_interpolation_binary_io.hpp), together with the
+    // constraints it was planned with, so it can be sampled and replanned
+    // without solving it again.
+    void setTrajectory(const BasicConstantAccTrajectory<Scalar>& trajectory, const Scalar amax, const Scalar vmax) {
+        _trajectory = trajectory;
+        _amax = amax;
+        _vmax = vmax;
+        _aSigned = trajectory.segmentCount > 0 ? trajectory.a[0] : Scalar(0);
+        _caseNum = trajectory.segmentCount == 3 ? 1 : 0;
+        _initialStateSetted = true;
+        _pointSetted = true;
+        _constraintsSetted = true;
+        _trajectoryCalced = trajectory.segmentCount > 0;
+        ++_revision;
+    }
 
-        if (tau < 0) {
-            a = 0.0;
-            v = _v0;
-            pos = _p0;
-        } else if (tau >= sum(_dt, _dt.size() + 1)) {
-            a = 0.0;
-            v = _ve;
-            pos = _pe;
-        } else {
-            double a_in = 0.0;
-            double v_in = 0.0;
-            double p_in = 0.0;
-            double t_in = tau;
-            for (int i = 0; i < _dt.size(); i++) {
-                double dt_i = sum(_dt, i + 1);
-                if (tau <= dt_i) {
-                    t_in = tau - sum(_dt, i);
-                    a_in = _a[i];
-                    v_in = _v[i];
-                    p_in = _p[i];
-                    break;
-                }
-            }
+    Scalar amax() const noexcept {
+        return _amax;
+    }
+
+    Scalar vmax() const noexcept {
+        return _vmax;
+    }
+
+    // Incremented by every setter, calcTrajectory() and replan(), so derived
+    // data such as a TrajectorySampleCache can tell when it is stale. Starts
+    // at a value no other planner of the process starts from; a copy keeps it.
+    std::uint64_t revision() const noexcept {
+        return _revision;
+    }
+
+    // Segment form of the current profile.
+    const BasicConstantAccTrajectory<Scalar>& trajectory() const noexcept {
+        return _trajectory;
+    }
 
-            a = a_in;
-            v = vInteg(v_in, a_in, t_in);
-            pos = pInteg(p_in, v_in, a_in, t_in);
+    BasicTrajectoryPoint<Scalar> getState(const Scalar t) const noexcept {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_STATS
+        const TrajectoryStatsScope statsScope(statsGetStateTimer);
+        trajectoryStatsCount(statsGetState);
+        const Scalar tau = t - _trajectory.t0;
+        if (tau < 0) {
+            trajectoryStatsCount(statsClampBefore);
+        } else if (tau >= _trajectory.duration) {
+            trajectoryStatsCount(statsClampAfter);
         }
+#endif
+        return _trajectory.getState(t);
+    }
+
+    // Cursor for streaming the current profile from time t onwards.
+    BasicTrajectoryCursor<Scalar> cursor(const Scalar t,
+                                         const unsigned resyncInterval =
+                                             BasicTrajectoryCursor<Scalar>::defaultResyncInterval) const noexcept {
+        return BasicTrajectoryCursor<Scalar>(_trajectory, t, resyncInterval);
+    }
+
+    void getPoint(const Scalar t, BasicTrajectoryPoint<Scalar>& out) const noexcept {
+        out = getState(t);
+    }
 
-        std::vector<double> result = {pos, v, a};
+    // Compatibility wrapper returning {pos, vel, acc}. Allocates; prefer
+    // getState() on real-time paths.
+    std::vector<Scalar> getPoint(const Scalar t) const {
+        const BasicTrajectoryPoint<Scalar> state = getState(t);
+        std::vector<Scalar> result = {state.pos, state.vel, state.acc};
         return result;
     }
 
+    // Number of samples sampleRange() writes for the grid tStart + k * dt < tEnd.
+    static std::size_t sampleCount(const Scalar tStart, const Scalar tEnd, const Scalar dt) noexcept {
+        return BasicConstantAccTrajectory<Scalar>::sampleCount(tStart, tEnd, dt);
+    }
+
+    // See ConstantAccTrajectory::sampleRange.
+    std::size_t sampleRange(const Scalar tStart, const Scalar tEnd, const Scalar dt,
+                            Scalar* time, Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        return _trajectory.sampleRange(tStart, tEnd, dt, time, pos, vel, acc);
+    }
+
+    // Samples count times sorted in ascending order into pos/vel/acc.
+    void sampleTimes(const Scalar* times, const std::size_t count,
+                     Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        _trajectory.sampleTimes(times, count, pos, vel, acc);
+    }
+
+    // See ConstantAccTrajectory::timeAtPosition; false before calcTrajectory().
+    // For TwoAngleInterpolation, pos is an unwrapped position.
+    bool timeAtPosition(const Scalar pos, Scalar& t,
+                        const Scalar tFrom = -std::numeric_limits<Scalar>::infinity()) const noexcept {
+        return _trajectoryCalced && _trajectory.timeAtPosition(pos, t, tFrom);
+    }
+
+    // See ConstantAccTrajectory::positionBounds; unwrapped positions for
+    // TwoAngleInterpolation.
+    BasicTrajectoryBounds<Scalar> positionBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        return _trajectory.positionBounds(tBegin, tEnd);
+    }
+
+    BasicTrajectoryBounds<Scalar> velocityBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        return _trajectory.velocityBounds(tBegin, tEnd);
+    }
+
+    BasicTrajectoryBounds<Scalar> accelerationBounds(const Scalar tBegin, const Scalar tEnd) const noexcept {
+        return _trajectory.accelerationBounds(tBegin, tEnd);
+    }
+
+    // See ConstantAccTrajectory::sampleEnvelope; unwrapped positions for
+    // TwoAngleInterpolation.
+    void sampleEnvelope(const Scalar tStart, const Scalar tEnd, const std::size_t bucketCount,
+                        Scalar* posLo, Scalar* posHi, Scalar* velLo, Scalar* velHi,
+                        Scalar* accLo, Scalar* accHi) const noexcept {
+        _trajectory.sampleEnvelope(tStart, tEnd, bucketCount, posLo, posHi, velLo, velHi, accLo, accHi);
+    }
+
+    // See ConstantAccTrajectory::timeAtVelocity; false before calcTrajectory().
+    bool timeAtVelocity(const Scalar vel, Scalar& t,
+                        const Scalar tFrom = -std::numeric_limits<Scalar>::infinity()) const noexcept {
+        return _trajectoryCalced && _trajectory.timeAtVelocity(vel, t, tFrom);
+    }
+
+    // Samples per chunk handed to the sink by sampleStream().
+    static const std::size_t sampleStreamChunk = 256;
+
+    // Samples the same grid as sampleRange() in chunks of up to
+    // sampleStreamChunk samples held on the stack, calling
+    // sink(time, pos, vel, acc, count) for each chunk in order, so memory use
+    // does not depend on the trajectory length. Returns the number of samples.
+    template <class Sink>
+    std::size_t sampleStream(const Scalar tStart, const Scalar tEnd, const Scalar dt, Sink&& sink) const {
+        Scalar time[sampleStreamChunk];
+        Scalar pos[sampleStreamChunk];
+        Scalar vel[sampleStreamChunk];
+        Scalar acc[sampleStreamChunk];
+        const std::size_t n = sampleCount(tStart, tEnd, dt);
+        for (std::size_t k = 0; k < n; k += sampleStreamChunk) {
+            const std::size_t kEnd = n - k < sampleStreamChunk ? n : k + sampleStreamChunk;
+            _trajectory.sampleGrid(tStart, dt, k, kEnd, time, pos, vel, acc);
+            sink(static_cast<const Scalar*>(time), static_cast<const Scalar*>(pos),
+                 static_cast<const Scalar*>(vel), static_cast<const Scalar*>(acc), kEnd - k);
+        }
+        return n;
+    }
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
 private:
-    double sum(const std::vector<double>& values, const int count) const {
-        double total = 0.0;
-        for (int i = 0; i < count && i < values.size(); ++i) {
-            total += values[i];
+    void traceSegments(const char* label, const Scalar* values, const std::size_t count) const {
+        double converted[BasicConstantAccTrajectory<Scalar>::maxSegments];
+        for (std::size_t i = 0; i < count; ++i) {
+            converted[i] = static_cast<double>(values[i]);
         }
-        return total;
+        _traceCallback(_traceUser, label, converted, count);
     }
+#endif
 };
 
+template <class Scalar>
+const std::size_t BasicTwoPointInterpolation<Scalar>::sampleStreamChunk;
+
+typedef BasicTwoPointInterpolation<double> TwoPointInterpolation;
+typedef BasicTwoPointInterpolation<float> TwoPointInterpolationFloat;
+
 class TwoAngleInterpolation : public TwoPointInterpolation {
 private:
     bool _normalize_output = true;
+    bool _fast_normalization = false;
+
+    double normalizeOutput(const double pos) const noexcept {
+        return _fast_normalization ? normalizeAxisFast(pos) : normalizeAxis(pos);
+    }
+
+    // Mode is checked once so the fast loop vectorizes.
+    void normalizeOutputs(double* pos, const std::size_t count) const noexcept {
+        if (_fast_normalization) {
+            for (std::size_t j = 0; j < count; ++j) {
+                pos[j] = normalizeAxisFast(pos[j]);
+            }
+        } else {
+            for (std::size_t j = 0; j < count; ++j) {
+                pos[j] = normalizeAxis(pos[j]);
+            }
+        }
+    }
+
 public:
     TwoAngleInterpolation(const bool verbose = false) : TwoPointInterpolation(verbose) {}
 
+    // Opt-in: normalize sampled positions with normalizeAxisFast instead of
+    // normalizeAxis (see there for the error bounds). init and replan keep
+    // using normalizeAxis, so the planned trajectory does not change.
+    void setFastNormalization(const bool enable) noexcept {
+        _fast_normalization = enable;
+    }
+
+    bool fastNormalization() const noexcept {
+        return _fast_normalization;
+    }
+
     void init(const double p0, const double pe, 
               const double amax, const double vmax, 
               const double t0 = 0, const double v0 = 0, 
@@ -259,12 +1365,68 @@ public:
         return TwoPointInterpolation::calcTrajectory();
     }
 
-    std::vector<double> getPoint(const double t, const bool normalize = true) const {
-        std::vector<double> result = TwoPointInterpolation::getPoint(t);
+    // TwoPointInterpolation::replan towards the angle pe, reached along the
+    // shortest way from the current end point. The tolerance is compared with
+    // the wrapped angle difference.
+    double replan(const double t, const double pe, const double ve = 0, const double tolerance = 0) {
+        const double currentPe = trajectory().pe;
+        const double dp = normalizeAxis(normalizeAxis(pe) - normalizeAxis(currentPe));
+        return TwoPointInterpolation::replan(t, currentPe + dp, ve, tolerance);
+    }
+
+    TrajectoryPoint getState(const double t, const bool normalize = true) const noexcept {
+        TrajectoryPoint result = TwoPointInterpolation::getState(t);
         if (normalize)
         {
-            result[0] = normalizeAxis(result[0]);
+            result.pos = normalizeOutput(result.pos);
         }
         return result;
     }
+
+    void getPoint(const double t, TrajectoryPoint& out, const bool normalize = true) const noexcept {
+        out = getState(t, normalize);
+    }
+
+    std::vector<double> getPoint(const double t, const bool normalize = true) const {
+        const TrajectoryPoint state = getState(t, normalize);
+        std::vector<double> result = {state.pos, state.vel, state.acc};
+        return result;
+    }
+
+    std::size_t sampleRange(const double tStart, const double tEnd, const double dt,
+                            double* time, double* pos, double* vel, double* acc,
+                            const bool normalize = true) const noexcept {
+        const std::size_t n = TwoPointInterpolation::sampleRange(tStart, tEnd, dt, time, pos, vel, acc);
+        if (normalize) {
+            normalizeOutputs(pos, n);
+        }
+        return n;
+    }
+
+    // TwoPointInterpolation::sampleStream with each chunk's positions normalized.
+    template <class Sink>
+    std::size_t sampleStream(const double tStart, const double tEnd, const double dt, Sink&& sink,
+                             const bool normalize = true) const {
+        return TwoPointInterpolation::sampleStream(tStart, tEnd, dt,
+            [this, &sink, normalize](const double* time, const double* pos, const double* vel,
+                                     const double* acc, const std::size_t count) {
+                if (!normalize) {
+                    sink(time, pos, vel, acc, count);
+                    return;
+                }
+                double normalized[sampleStreamChunk];
+                std::copy(pos, pos + count, normalized);
+                normalizeOutputs(normalized, count);
+                sink(time, static_cast<const double*>(normalized), vel, acc, count);
+            });
+    }
+
+    void sampleTimes(const double* times, const std::size_t count,
+                     double* pos, double* vel, double* acc,
+                     const bool normalize = true) const noexcept {
+        TwoPointInterpolation::sampleTimes(times, count, pos, vel, acc);
+        if (normalize) {
+            normalizeOutputs(pos, count);
+        }
+    }
 };
\ No newline at end of file
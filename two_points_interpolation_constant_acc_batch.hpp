@@ -0,0 +1,466 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Tells the compiler the batch loops carry no dependencies between axes, so
+// they vectorize without run-time alias checks between the SoA arrays.
+#if defined(__clang__)
+#define TWO_POINTS_INTERPOLATION_IVDEP _Pragma("clang loop vectorize(assume_safety)")
+#elif defined(__GNUC__)
+#define TWO_POINTS_INTERPOLATION_IVDEP _Pragma("GCC ivdep")
+#else
+#define TWO_POINTS_INTERPOLATION_IVDEP
+#endif
+
+// Solves many independent constant-acceleration profiles at once.
+//
+// Every axis is stored as exactly three segments (accelerate, coast,
+// decelerate) in structure-of-arrays layout: segment k of all axes is
+// contiguous. A case 0 profile simply has a zero-length coast segment, so the
+// solve and sample loops have no data-dependent control flow and can be
+// auto-vectorized (build with -O3 -fno-math-errno -fno-trapping-math so the
+// selects and std::sqrt vectorize).
+// Results match TwoPointInterpolation bit for bit (and
+// BasicTwoPointInterpolation<float> for the float instantiation).
+template <class Scalar>
+class BasicTwoPointInterpolationBatch {
+public:
+    static const std::size_t segmentCount = 3;
+
+private:
+    std::size_t _size;
+
+    std::vector<Scalar> _t0;
+    std::vector<Scalar> _p0;
+    std::vector<Scalar> _v0;
+    std::vector<Scalar> _pe;
+    std::vector<Scalar> _ve;
+    std::vector<Scalar> _amax;
+    std::vector<Scalar> _vmax;
+
+    std::vector<Scalar> _dt[segmentCount];
+    std::vector<Scalar> _a[segmentCount];
+    std::vector<Scalar> _v[segmentCount];
+    std::vector<Scalar> _p[segmentCount];
+    std::vector<Scalar> _segmentEnd[segmentCount]; // cumulative end time of each segment, relative to _t0
+    std::vector<Scalar> _duration;                  // -1 for infeasible axes
+    std::vector<int> _caseNum;                      // -1 for infeasible axes
+
+public:
+    BasicTwoPointInterpolationBatch(const std::size_t size = 0) : _size(0) {
+        resize(size);
+    }
+
+    void resize(const std::size_t size) {
+        _size = size;
+        _t0.assign(size, Scalar(0));
+        _p0.assign(size, Scalar(0));
+        _v0.assign(size, Scalar(0));
+        _pe.assign(size, Scalar(0));
+        _ve.assign(size, Scalar(0));
+        _amax.assign(size, Scalar(0));
+        _vmax.assign(size, Scalar(0));
+        for (std::size_t k = 0; k < segmentCount; ++k) {
+            _dt[k].assign(size, Scalar(0));
+            _a[k].assign(size, Scalar(0));
+            _v[k].assign(size, Scalar(0));
+            _p[k].assign(size, Scalar(0));
+            _segmentEnd[k].assign(size, Scalar(0));
+        }
+        _duration.assign(size, Scalar(-1));
+        _caseNum.assign(size, -1);
+    }
+
+    std::size_t size() const {
+        return _size;
+    }
+
+    void setAxis(const std::size_t i,
+                 const Scalar p0, const Scalar pe,
+                 const Scalar amax, const Scalar vmax,
+                 const Scalar t0 = 0, const Scalar v0 = 0,
+                 const Scalar ve = 0) {
+        _p0[i] = p0;
+        _pe[i] = pe;
+        _amax[i] = amax;
+        _vmax[i] = vmax;
+        _t0[i] = t0;
+        _v0[i] = v0;
+        _ve[i] = ve;
+    }
+
+    // Copies count axes from separate input arrays. t0, v0 and ve may be
+    // null, in which case they default to zero as in TwoPointInterpolation::init.
+    void init(const std::size_t count,
+              const Scalar* p0, const Scalar* pe,
+              const Scalar* amax, const Scalar* vmax,
+              const Scalar* t0 = nullptr, const Scalar* v0 = nullptr,
+              const Scalar* ve = nullptr) {
+        resize(count);
+        for (std::size_t i = 0; i < count; ++i) {
+            setAxis(i, p0[i], pe[i], amax[i], vmax[i],
+                    t0 ? t0[i] : Scalar(0), v0 ? v0[i] : Scalar(0), ve ? ve[i] : Scalar(0));
+        }
+    }
+
+    // Solves every axis. Returns the longest duration, or -1 if any axis is
+    // infeasible (see duration() for the per-axis result).
+    Scalar calcTrajectory() {
+        const std::size_t n = _size;
+        const Scalar* p0 = _p0.data();
+        const Scalar* pe = _pe.data();
+        const Scalar* v0 = _v0.data();
+        const Scalar* ve = _ve.data();
+        const Scalar* amax = _amax.data();
+        const Scalar* vmax = _vmax.data();
+        Scalar* dt0 = _dt[0].data();
+        Scalar* dt1 = _dt[1].data();
+        Scalar* dt2 = _dt[2].data();
+        Scalar* a0 = _a[0].data();
+        Scalar* a1 = _a[1].data();
+        Scalar* a2 = _a[2].data();
+        Scalar* sv0 = _v[0].data();
+        Scalar* sv1 = _v[1].data();
+        Scalar* sv2 = _v[2].data();
+        Scalar* sp0 = _p[0].data();
+        Scalar* sp1 = _p[1].data();
+        Scalar* sp2 = _p[2].data();
+        Scalar* e0 = _segmentEnd[0].data();
+        Scalar* e1 = _segmentEnd[1].data();
+        Scalar* e2 = _segmentEnd[2].data();
+        Scalar* duration = _duration.data();
+        int* caseNum = _caseNum.data();
+
+        TWO_POINTS_INTERPOLATION_IVDEP
+        for (std::size_t i = 0; i < n; ++i) {
+            const Scalar dp = pe[i] - p0[i];
+            const Scalar dv = ve[i] - v0[i];
+            const Scalar aSigned = amax[i] * dp / std::fabs(dp);
+            const Scalar b = v0[i] / aSigned;
+            const Scalar c = (-dv * (ve[i] + v0[i]) * Scalar(0.5) / aSigned - dp) / aSigned;
+            const Scalar disc = b * b - c;
+            const bool feasible = disc > 0;
+
+            // case 0: accelerate then decelerate
+            const Scalar dt01 = -b + std::sqrt(feasible ? disc : Scalar(0));
+            const Scalar v1 = vInteg(v0[i], aSigned, dt01);
+            const Scalar p1 = pInteg(p0[i], v0[i], aSigned, dt01);
+            const Scalar dt1e = dt01 - dv / aSigned;
+
+            // case 1: accelerate to vmax, coast, decelerate
+            const Scalar v1c = vmax[i] * dp / std::fabs(dp);
+            const Scalar dt01c = (v1c - v0[i]) / aSigned;
+            const Scalar p1c = pInteg(p0[i], v0[i], aSigned, dt01c);
+            const Scalar dt2e = (ve[i] - v1c) / -aSigned;
+            const Scalar dp2e = pInteg(Scalar(0), v1c, -aSigned, dt2e);
+            const Scalar dt12 = (pe[i] - p1c - dp2e) / v1c;
+            const Scalar p2 = pe[i] - dp2e;
+
+            const bool coast = std::fabs(v1) >= vmax[i];
+
+            const Scalar d0 = feasible ? (coast ? dt01c : dt01) : Scalar(0);
+            const Scalar d1 = feasible ? (coast ? dt12 : Scalar(0)) : Scalar(0);
+            const Scalar d2 = feasible ? (coast ? dt2e : dt1e) : Scalar(0);
+            dt0[i] = d0;
+            dt1[i] = d1;
+            dt2[i] = d2;
+            a0[i] = aSigned;
+            a1[i] = Scalar(0);
+            a2[i] = -aSigned;
+            sv0[i] = v0[i];
+            sv1[i] = coast ? v1c : v1;
+            sv2[i] = coast ? v1c : v1;
+            sp0[i] = p0[i];
+            sp1[i] = coast ? p1c : p1;
+            sp2[i] = coast ? p2 : p1;
+            e0[i] = d0;
+            e1[i] = d0 + d1;
+            e2[i] = (d0 + d1) + d2;
+            duration[i] = feasible ? e2[i] : Scalar(-1);
+            caseNum[i] = feasible ? (coast ? 1 : 0) : -1;
+        }
+
+        Scalar longest = Scalar(0);
+        for (std::size_t i = 0; i < n; ++i) {
+            if (duration[i] < 0) {
+                return -1;
+            }
+            longest = duration[i] > longest ? duration[i] : longest;
+        }
+        return longest;
+    }
+
+    // Solves every axis for minimum time, then re-times all axes in closed
+    // form so they arrive together at the latest arrival time t0 + duration.
+    // An axis with p0 == pe and zero boundary velocities simply holds. Returns
+    // the common arrival time, or -1 if an axis is infeasible (including a
+    // minimum-time solution with a negative phase) or cannot be stretched to
+    // the common arrival within its limits; in that case the remaining axes
+    // keep their minimum-time profiles.
+    Scalar calcSynchronizedTrajectory() {
+        calcTrajectory();
+
+        // the axis arriving last keeps its profile; arrival - t0 need not
+        // round back to its duration, so it is identified by index
+        std::size_t slowest = _size;
+        Scalar arrival = Scalar(0);
+        for (std::size_t i = 0; i < _size; ++i) {
+            if (isHold(i)) {
+                continue;
+            }
+            if (_duration[i] < 0 || _dt[0][i] < 0 || _dt[1][i] < 0 || _dt[2][i] < 0) {
+                return -1;
+            }
+            const Scalar tEnd = _t0[i] + _duration[i];
+            if (slowest == _size || tEnd > arrival) {
+                arrival = tEnd;
+                slowest = i;
+            }
+        }
+
+        for (std::size_t i = 0; i < _size; ++i) {
+            if (i == slowest) {
+                continue;
+            }
+            const Scalar T = slowest < _size ? arrival - _t0[i] : Scalar(0);
+            if (!retimeAxis(i, T)) {
+                return -1;
+            }
+        }
+        return arrival;
+    }
+
+    Scalar duration(const std::size_t i) const {
+        return _duration[i];
+    }
+
+    int caseNum(const std::size_t i) const {
+        return _caseNum[i];
+    }
+
+    Scalar segmentDuration(const std::size_t i, const std::size_t k) const {
+        return _dt[k][i];
+    }
+
+    // Segment form of axis i as TwoPointInterpolation would store it (a case 0
+    // profile has no coast segment). Infeasible axes get no segments.
+    void getTrajectory(const std::size_t i, BasicConstantAccTrajectory<Scalar>& out) const noexcept {
+        out.t0 = _t0[i];
+        out.p0 = _p0[i];
+        out.v0 = _v0[i];
+        out.pe = _pe[i];
+        out.ve = _ve[i];
+        out.clearSegments();
+        if (_caseNum[i] < 0) {
+            return;
+        }
+        for (std::size_t k = 0; k < segmentCount; ++k) {
+            if (k == 1 && _caseNum[i] == 0) {
+                continue;
+            }
+            out.addSegment(_dt[k][i], _a[k][i], _v[k][i], _p[k][i]);
+        }
+    }
+
+    BasicTrajectoryPoint<Scalar> getState(const std::size_t i, const Scalar t) const noexcept {
+        const Scalar tau = t - _t0[i];
+        BasicTrajectoryPoint<Scalar> result;
+        if (tau < 0) {
+            result.pos = _p0[i];
+            result.vel = _v0[i];
+            result.acc = Scalar(0);
+        } else if (tau >= _segmentEnd[segmentCount - 1][i]) {
+            result.pos = _pe[i];
+            result.vel = _ve[i];
+            result.acc = Scalar(0);
+        } else {
+            const std::size_t k = tau <= _segmentEnd[0][i] ? 0 : (tau <= _segmentEnd[1][i] ? 1 : 2);
+            const Scalar t_in = tau - (k == 0 ? Scalar(0) : _segmentEnd[k - 1][i]);
+            result.pos = pInteg(_p[k][i], _v[k][i], _a[k][i], t_in);
+            result.vel = vInteg(_v[k][i], _a[k][i], t_in);
+            result.acc = _a[k][i];
+        }
+        return result;
+    }
+
+    // Position range of every axis over [tBegin, tEnd] into lo/hi, each of
+    // size(); see ConstantAccTrajectory::positionBounds.
+    void positionBounds(const Scalar tBegin, const Scalar tEnd, Scalar* lo, Scalar* hi) const noexcept {
+        bounds(tBegin, tEnd, true, lo, hi);
+    }
+
+    // Velocity range of every axis over [tBegin, tEnd] into lo/hi.
+    void velocityBounds(const Scalar tBegin, const Scalar tEnd, Scalar* lo, Scalar* hi) const noexcept {
+        bounds(tBegin, tEnd, false, lo, hi);
+    }
+
+    // Samples every axis at the same time t into pos/vel/acc, each of size().
+    void getPoints(const Scalar t, Scalar* pos, Scalar* vel, Scalar* acc) const noexcept {
+        const std::size_t n = _size;
+        const Scalar* t0 = _t0.data();
+        const Scalar* pStart = _p0.data();
+        const Scalar* vStart = _v0.data();
+        const Scalar* pEnd = _pe.data();
+        const Scalar* vEnd = _ve.data();
+        const Scalar* a0 = _a[0].data();
+        const Scalar* a1 = _a[1].data();
+        const Scalar* a2 = _a[2].data();
+        const Scalar* sv0 = _v[0].data();
+        const Scalar* sv1 = _v[1].data();
+        const Scalar* sv2 = _v[2].data();
+        const Scalar* sp0 = _p[0].data();
+        const Scalar* sp1 = _p[1].data();
+        const Scalar* sp2 = _p[2].data();
+        const Scalar* e0 = _segmentEnd[0].data();
+        const Scalar* e1 = _segmentEnd[1].data();
+        const Scalar* e2 = _segmentEnd[2].data();
+
+        TWO_POINTS_INTERPOLATION_IVDEP
+        for (std::size_t i = 0; i < n; ++i) {
+            const Scalar tau = t - t0[i];
+            const bool in0 = tau <= e0[i];
+            const bool in1 = tau <= e1[i];
+            const Scalar a = in0 ? a0[i] : (in1 ? a1[i] : a2[i]);
+            const Scalar v = in0 ? sv0[i] : (in1 ? sv1[i] : sv2[i]);
+            const Scalar p = in0 ? sp0[i] : (in1 ? sp1[i] : sp2[i]);
+            const Scalar start = in0 ? Scalar(0) : (in1 ? e0[i] : e1[i]);
+            const Scalar t_in = tau - start;
+            const bool before = tau < 0;
+            const bool after = tau >= e2[i];
+            pos[i] = before ? pStart[i] : (after ? pEnd[i] : pInteg(p, v, a, t_in));
+            vel[i] = before ? vStart[i] : (after ? vEnd[i] : vInteg(v, a, t_in));
+            acc[i] = (before || after) ? Scalar(0) : a;
+        }
+    }
+
+private:
+    void bounds(const Scalar tBegin, const Scalar tEnd, const bool position, Scalar* lo, Scalar* hi) const noexcept {
+        for (std::size_t i = 0; i < _size; ++i) {
+            const BasicTrajectoryPoint<Scalar> first = getState(i, tBegin);
+            BasicTrajectoryBounds<Scalar> result = {position ? first.pos : first.vel, position ? first.pos : first.vel};
+            if (tEnd > tBegin) {
+                const BasicTrajectoryPoint<Scalar> last = getState(i, tEnd);
+                result.include(position ? last.pos : last.vel);
+                const Scalar tauBegin = tBegin - _t0[i];
+                const Scalar tauEnd = tEnd - _t0[i];
+                for (std::size_t k = 0; k < segmentCount; ++k) {
+                    const Scalar start = k == 0 ? Scalar(0) : _segmentEnd[k - 1][i];
+                    const Scalar end = _segmentEnd[k][i];
+                    const Scalar sBegin = (tauBegin > start ? tauBegin : start) - start;
+                    const Scalar sEnd = (tauEnd < end ? tauEnd : end) - start;
+                    if (sBegin <= sEnd) {
+                        widenSegmentBounds(_p[k][i], _v[k][i], _a[k][i], sBegin, sEnd, position, result);
+                    }
+                }
+            }
+            lo[i] = result.lo;
+            hi[i] = result.hi;
+        }
+    }
+
+    // Relative tolerance of the re-timing; 1e-12 for double, a few thousand
+    // ulps for float.
+    static Scalar retimeTolerance() {
+        const Scalar scaled = Scalar(4096) * std::numeric_limits<Scalar>::epsilon();
+        return scaled > Scalar(1e-12) ? scaled : Scalar(1e-12);
+    }
+
+    bool isHold(const std::size_t i) const {
+        return _pe[i] == _p0[i] && _v0[i] == Scalar(0) && _ve[i] == Scalar(0);
+    }
+
+    // Replaces axis i with an accelerate/coast/decelerate profile of exactly
+    // duration T. Each ramp runs at +-amax; for every combination of ramp
+    // directions the coast velocity vc follows in closed form from
+    //   dp = (vc^2 - v0^2) / (2 a1) + vc * t2 + (vc^2 - ve^2) / (2 a3),
+    //   t1 = (vc - v0) / a1, t3 = (vc - ve) / a3, t2 = T - t1 - t3,
+    // which is quadratic in vc when a1 == a3 and linear otherwise. The first
+    // candidate with non-negative phases and |vc| <= vmax is used, trying the
+    // natural direction (ramps along dp) first.
+    bool retimeAxis(const std::size_t i, const Scalar T) {
+        const Scalar p0 = _p0[i];
+        const Scalar pe = _pe[i];
+        const Scalar v0 = _v0[i];
+        const Scalar ve = _ve[i];
+        const Scalar amax = _amax[i];
+        const Scalar vmax = _vmax[i];
+        const Scalar dp = pe - p0;
+        const Scalar s = dp < 0 ? Scalar(-1) : Scalar(1);
+        const Scalar relTol = retimeTolerance();
+        const Scalar tol = relTol * (T > Scalar(1) ? T : Scalar(1));
+        const Scalar signs[4][2] = {{s, s}, {s, -s}, {-s, s}, {-s, -s}};
+
+        for (int c = 0; c < 4; ++c) {
+            const Scalar a1 = signs[c][0] * amax;
+            const Scalar a3 = signs[c][1] * amax;
+            Scalar candidates[2];
+            int candidateCount = 0;
+            if (a1 == a3) {
+                const Scalar B = a1 * T + v0 + ve;
+                const Scalar C = Scalar(0.5) * (v0 * v0 + ve * ve) + a1 * dp;
+                Scalar D = B * B - 4 * C;
+                if (D < 0) {
+                    if (D < -relTol * B * B) {
+                        continue;
+                    }
+                    D = 0;
+                }
+                const Scalar root = std::sqrt(D);
+                candidates[candidateCount++] = Scalar(0.5) * (B - signs[c][0] * root);
+                candidates[candidateCount++] = Scalar(0.5) * (B + signs[c][0] * root);
+            } else {
+                const Scalar denom = T + (v0 - ve) / a1;
+                if (denom == 0) {
+                    continue;
+                }
+                candidates[candidateCount++] = (dp + Scalar(0.5) * (v0 * v0 - ve * ve) / a1) / denom;
+            }
+
+            for (int k = 0; k < candidateCount; ++k) {
+                const Scalar vc = candidates[k];
+                Scalar t1 = (vc - v0) / a1;
+                Scalar t3 = (vc - ve) / a3;
+                Scalar t2 = T - t1 - t3;
+                if (t1 < -tol || t2 < -tol || t3 < -tol || std::fabs(vc) > vmax * (1 + relTol)) {
+                    continue;
+                }
+                t1 = t1 > 0 ? t1 : Scalar(0);
+                t3 = t3 > 0 ? t3 : Scalar(0);
+                t2 = t2 > 0 ? t2 : Scalar(0);
+
+                const Scalar p1 = pInteg(p0, v0, a1, t1);
+                const Scalar p2 = pe - pInteg(Scalar(0), vc, -a3, t3);
+                _dt[0][i] = t1;
+                _dt[1][i] = t2;
+                _dt[2][i] = t3;
+                _a[0][i] = a1;
+                _a[1][i] = Scalar(0);
+                _a[2][i] = -a3;
+                _v[0][i] = v0;
+                _v[1][i] = vc;
+                _v[2][i] = vc;
+                _p[0][i] = p0;
+                _p[1][i] = p1;
+                _p[2][i] = p2;
+                _segmentEnd[0][i] = t1;
+                _segmentEnd[1][i] = t1 + t2;
+                _segmentEnd[2][i] = (t1 + t2) + t3;
+                _duration[i] = _segmentEnd[2][i];
+                _caseNum[i] = 1;
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+template <class Scalar>
+const std::size_t BasicTwoPointInterpolationBatch<Scalar>::segmentCount;
+
+typedef BasicTwoPointInterpolationBatch<double> TwoPointInterpolationBatch;
+typedef BasicTwoPointInterpolationBatch<float> TwoPointInterpolationBatchFloat;
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Profile materialized once on a uniform grid, for consumers that sample the
+// same trajectory many times at a fixed dt (plotting, logging). The samples
+// are kept as four contiguous, cache-line aligned arrays and served by index
+// or by linear interpolation between neighbouring samples. The cache records
+// the address and revision() of the interpolation it was built from;
+// isValidFor() is false for any other planner, and turns false as soon as a
+// setter, calcTrajectory() or replan() runs on the source.
+//
+//   TrajectorySampleCache cache;
+//   cache.build(tpi, t0, t0 + te, dt);
+//   for (std::size_t k = 0; k < cache.size(); ++k) { cache.getPoint(k, point); ... }
+class TrajectorySampleCache {
+private:
+    static const std::size_t alignment = 64;
+    static const std::size_t alignmentDoubles = alignment / sizeof(double);
+
+    std::vector<double> _storage;
+    double* _time;
+    double* _pos;
+    double* _vel;
+    double* _acc;
+    std::size_t _size;
+    std::size_t _stride; // distance between the arrays, rounded up to a cache line
+    double _tStart;
+    double _dt;
+    const TwoPointInterpolation* _source;
+    std::uint64_t _revision;
+    bool _built;
+
+public:
+    TrajectorySampleCache()
+        : _time(nullptr), _pos(nullptr), _vel(nullptr), _acc(nullptr),
+          _size(0), _stride(0), _tStart(0.0), _dt(0.0), _source(nullptr), _revision(0),
+          _built(false) {}
+
+    // The arrays point into _storage, so copies would alias it.
+    TrajectorySampleCache(const TrajectorySampleCache&) = delete;
+    TrajectorySampleCache& operator=(const TrajectorySampleCache&) = delete;
+
+    // Samples interpolation on the grid tStart + k * dt < tEnd (see
+    // sampleRange). Storage is reused when it is large enough. Returns false,
+    // leaving the cache empty, if no profile has been calculated.
+    bool build(const TwoPointInterpolation& interpolation,
+               const double tStart, const double tEnd, const double dt) {
+        clear();
+        if (!interpolation.isInitialized()) {
+            return false;
+        }
+        const std::size_t n = TwoPointInterpolation::sampleCount(tStart, tEnd, dt);
+        _stride = (n + alignmentDoubles - 1) / alignmentDoubles * alignmentDoubles;
+        if (_storage.size() < 4 * _stride + alignmentDoubles) {
+            _storage.resize(4 * _stride + alignmentDoubles);
+        }
+        const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(_storage.data());
+        const std::size_t offset = (alignment - address % alignment) % alignment / sizeof(double);
+        _time = _storage.data() + offset;
+        _pos = _time + _stride;
+        _vel = _pos + _stride;
+        _acc = _vel + _stride;
+
+        _size = interpolation.sampleRange(tStart, tEnd, dt, _time, _pos, _vel, _acc);
+        _tStart = tStart;
+        _dt = dt;
+        _source = &interpolation;
+        _revision = interpolation.revision();
+        _built = true;
+        return true;
+    }
+
+    // Drops the samples but keeps the storage for the next build().
+    void clear() noexcept {
+        _size = 0;
+        _built = false;
+    }
+
+    // True if the cache was built from interpolation and it has not changed since.
+    bool isValidFor(const TwoPointInterpolation& interpolation) const noexcept {
+        return _built && _source == &interpolation && _revision == interpolation.revision();
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    double startTime() const noexcept {
+        return _tStart;
+    }
+
+    double timeStep() const noexcept {
+        return _dt;
+    }
+
+    const double* time() const noexcept { return _time; }
+    const double* pos() const noexcept { return _pos; }
+    const double* vel() const noexcept { return _vel; }
+    const double* acc() const noexcept { return _acc; }
+
+    // Sample k, 0 <= k < size().
+    void getPoint(const std::size_t k, TrajectoryPoint& out) const noexcept {
+        out.pos = _pos[k];
+        out.vel = _vel[k];
+        out.acc = _acc[k];
+    }
+
+    // Linear interpolation between the two samples around t, clamped to the
+    // first and last sample. The acceleration is taken from the earlier
+    // sample, since it is piecewise constant. Requires size() > 0.
+    TrajectoryPoint getState(const double t) const noexcept {
+        TrajectoryPoint result;
+        const double x = (t - _tStart) / _dt;
+        if (!(x > 0)) {
+            getPoint(0, result);
+            return result;
+        }
+        const std::size_t k = static_cast<std::size_t>(x);
+        if (k + 1 >= _size) {
+            getPoint(_size - 1, result);
+            return result;
+        }
+        const double w = x - static_cast<double>(k);
+        result.pos = _pos[k] + w * (_pos[k + 1] - _pos[k]);
+        result.vel = _vel[k] + w * (_vel[k + 1] - _vel[k]);
+        result.acc = _acc[k];
+        return result;
+    }
+
+    // Bytes held by the cache, including unused capacity.
+    std::size_t memoryUsage() const noexcept {
+        return sizeof(*this) + _storage.capacity() * sizeof(double);
+    }
+};
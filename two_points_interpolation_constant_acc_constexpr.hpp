@@ -0,0 +1,43 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Compile-time solving and sampling of constant-acceleration profiles, for
+// moves whose parameters are known at build time (homing moves, fixtures).
+// Requires C++17 and a compiler that can detect constant evaluation
+// (std::is_constant_evaluated or __builtin_is_constant_evaluated).
+//
+//   constexpr ConstantAccTrajectory homing = makeConstantAccTrajectory(0.0, 1.0, 2.0, 0.5);
+//   constexpr auto table = makeSampleTable<256>(homing, 0.0, homing.duration / 256);
+//   static_assert(table.pos[255] <= 1.0, "");
+#if !TWO_POINTS_INTERPOLATION_HAS_CONSTEXPR
+#error "two_points_interpolation_constant_acc_constexpr.hpp requires C++17 constant evaluation support"
+#endif
+
+// N samples of a profile on the uniform grid tStart + k * dt.
+template <std::size_t N>
+struct TrajectorySampleTable {
+    std::array<double, N> time;
+    std::array<double, N> pos;
+    std::array<double, N> vel;
+    std::array<double, N> acc;
+};
+
+template <std::size_t N>
+constexpr TrajectorySampleTable<N> makeSampleTable(const ConstantAccTrajectory& trajectory,
+                                                   const double tStart, const double dt) noexcept {
+    TrajectorySampleTable<N> table{};
+    for (std::size_t k = 0; k < N; ++k) {
+        const double t = tStart + static_cast<double>(k) * dt;
+        const TrajectoryPoint state = trajectory.getState(t);
+        table.time[k] = t;
+        table.pos[k] = state.pos;
+        table.vel[k] = state.vel;
+        table.acc[k] = state.acc;
+    }
+    return table;
+}
+
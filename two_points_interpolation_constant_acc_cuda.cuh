@@ -0,0 +1,292 @@
+#pragma once
+
+#include <cstddef>
+
+#include <cuda_runtime.h>
+
+// GPU version of TwoPointInterpolationBatch: one thread per profile solves the
+// closed-form case 0 / case 1 profile and one thread per profile samples it.
+// All buffers stay on the device, so solve and sample run back to back
+// without host round trips; inputs are uploaded once and outputs are only
+// copied back on request.
+//
+// The per-profile arithmetic is the one of TwoPointInterpolationBatch. With
+// FMA contraction disabled (nvcc --fmad=false; the CMake target sets it) the
+// results match the CPU bit for bit, since CUDA's division and sqrt are
+// correctly rounded by default.
+//
+//   TwoPointInterpolationCudaBatch batch(n);
+//   batch.upload(p0, pe, amax, vmax, t0, v0, ve);   // host arrays
+//   batch.calcTrajectory();
+//   batch.getPoints(t, dPos, dVel, dAcc);           // device arrays
+//   batch.download(durations, caseNums);             // optional
+
+// Device-side SoA arrays of a batch, passed to the kernels by value.
+template <class Scalar>
+struct CudaTrajectoryBatchView {
+    std::size_t size;
+    const Scalar* t0;
+    const Scalar* p0;
+    const Scalar* v0;
+    const Scalar* pe;
+    const Scalar* ve;
+    const Scalar* amax;
+    const Scalar* vmax;
+    Scalar* dt[3];
+    Scalar* a[3];
+    Scalar* v[3];
+    Scalar* p[3];
+    Scalar* segmentEnd[3]; // cumulative end time of each segment, relative to t0
+    Scalar* duration;      // -1 for infeasible profiles
+    int* caseNum;          // -1 for infeasible profiles
+};
+
+template <class Scalar>
+__device__ inline Scalar cudaVInteg(const Scalar v0, const Scalar a, const Scalar dt) {
+    return v0 + a * dt;
+}
+
+template <class Scalar>
+__device__ inline Scalar cudaPInteg(const Scalar p0, const Scalar v0, const Scalar a, const Scalar dt) {
+    return p0 + v0 * dt + Scalar(0.5) * a * dt * dt;
+}
+
+template <class Scalar>
+__global__ void solveConstantAccBatchKernel(const CudaTrajectoryBatchView<Scalar> b) {
+    const std::size_t i = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (i >= b.size) {
+        return;
+    }
+    const Scalar p0 = b.p0[i];
+    const Scalar pe = b.pe[i];
+    const Scalar v0 = b.v0[i];
+    const Scalar ve = b.ve[i];
+    const Scalar amax = b.amax[i];
+    const Scalar vmax = b.vmax[i];
+
+    const Scalar dp = pe - p0;
+    const Scalar dv = ve - v0;
+    const Scalar aSigned = amax * dp / fabs(dp);
+    const Scalar bq = v0 / aSigned;
+    const Scalar c = (-dv * (ve + v0) * Scalar(0.5) / aSigned - dp) / aSigned;
+    const Scalar disc = bq * bq - c;
+    const bool feasible = disc > 0;
+
+    // case 0: accelerate then decelerate
+    const Scalar dt01 = -bq + sqrt(feasible ? disc : Scalar(0));
+    const Scalar v1 = cudaVInteg(v0, aSigned, dt01);
+    const Scalar p1 = cudaPInteg(p0, v0, aSigned, dt01);
+    const Scalar dt1e = dt01 - dv / aSigned;
+
+    // case 1: accelerate to vmax, coast, decelerate
+    const Scalar v1c = vmax * dp / fabs(dp);
+    const Scalar dt01c = (v1c - v0) / aSigned;
+    const Scalar p1c = cudaPInteg(p0, v0, aSigned, dt01c);
+    const Scalar dt2e = (ve - v1c) / -aSigned;
+    const Scalar dp2e = cudaPInteg(Scalar(0), v1c, -aSigned, dt2e);
+    const Scalar dt12 = (pe - p1c - dp2e) / v1c;
+    const Scalar p2 = pe - dp2e;
+
+    const bool coast = fabs(v1) >= vmax;
+
+    const Scalar d0 = feasible ? (coast ? dt01c : dt01) : Scalar(0);
+    const Scalar d1 = feasible ? (coast ? dt12 : Scalar(0)) : Scalar(0);
+    const Scalar d2 = feasible ? (coast ? dt2e : dt1e) : Scalar(0);
+    b.dt[0][i] = d0;
+    b.dt[1][i] = d1;
+    b.dt[2][i] = d2;
+    b.a[0][i] = aSigned;
+    b.a[1][i] = Scalar(0);
+    b.a[2][i] = -aSigned;
+    b.v[0][i] = v0;
+    b.v[1][i] = coast ? v1c : v1;
+    b.v[2][i] = coast ? v1c : v1;
+    b.p[0][i] = p0;
+    b.p[1][i] = coast ? p1c : p1;
+    b.p[2][i] = coast ? p2 : p1;
+    const Scalar e2 = (d0 + d1) + d2;
+    b.segmentEnd[0][i] = d0;
+    b.segmentEnd[1][i] = d0 + d1;
+    b.segmentEnd[2][i] = e2;
+    b.duration[i] = feasible ? e2 : Scalar(-1);
+    b.caseNum[i] = feasible ? (coast ? 1 : 0) : -1;
+}
+
+template <class Scalar>
+__global__ void sampleConstantAccBatchKernel(const CudaTrajectoryBatchView<Scalar> b, const Scalar t,
+                                             Scalar* pos, Scalar* vel, Scalar* acc) {
+    const std::size_t i = static_cast<std::size_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+    if (i >= b.size) {
+        return;
+    }
+    const Scalar tau = t - b.t0[i];
+    const Scalar e0 = b.segmentEnd[0][i];
+    const Scalar e1 = b.segmentEnd[1][i];
+    const bool in0 = tau <= e0;
+    const bool in1 = tau <= e1;
+    const int k = in0 ? 0 : (in1 ? 1 : 2);
+    const Scalar a = b.a[k][i];
+    const Scalar v = b.v[k][i];
+    const Scalar p = b.p[k][i];
+    const Scalar t_in = tau - (in0 ? Scalar(0) : (in1 ? e0 : e1));
+    const bool before = tau < 0;
+    const bool after = tau >= b.segmentEnd[2][i];
+    pos[i] = before ? b.p0[i] : (after ? b.pe[i] : cudaPInteg(p, v, a, t_in));
+    vel[i] = before ? b.v0[i] : (after ? b.ve[i] : cudaVInteg(v, a, t_in));
+    acc[i] = (before || after) ? Scalar(0) : a;
+}
+
+// Owns the device buffers of count profiles. Every call is asynchronous on
+// the given stream; methods return false when a CUDA call fails, and
+// lastError() tells which error it was.
+template <class Scalar>
+class BasicTwoPointInterpolationCudaBatch {
+public:
+    static const unsigned blockSize = 256;
+
+private:
+    static const std::size_t inputCount = 7;   // t0, p0, v0, pe, ve, amax, vmax
+    static const std::size_t outputCount = 16; // dt, a, v, p, segmentEnd (3 each), duration
+
+    std::size_t _size;
+    Scalar* _buffer;   // inputCount + outputCount arrays of _size elements
+    int* _caseNum;
+    cudaError_t _lastError;
+
+    Scalar* array(const std::size_t k) const {
+        return _buffer + k * _size;
+    }
+
+    bool check(const cudaError_t error) {
+        _lastError = error;
+        return error == cudaSuccess;
+    }
+
+    unsigned gridSize() const {
+        return static_cast<unsigned>((_size + blockSize - 1) / blockSize);
+    }
+
+public:
+    explicit BasicTwoPointInterpolationCudaBatch(const std::size_t size = 0)
+        : _size(0), _buffer(nullptr), _caseNum(nullptr), _lastError(cudaSuccess) {
+        resize(size);
+    }
+
+    ~BasicTwoPointInterpolationCudaBatch() {
+        cudaFree(_buffer);
+        cudaFree(_caseNum);
+    }
+
+    BasicTwoPointInterpolationCudaBatch(const BasicTwoPointInterpolationCudaBatch&) = delete;
+    BasicTwoPointInterpolationCudaBatch& operator=(const BasicTwoPointInterpolationCudaBatch&) = delete;
+
+    // Reallocates the device buffers for size profiles; their contents are lost.
+    // If an allocation fails, the batch is left empty, with size() 0, so no
+    // kernel runs on a missing buffer.
+    bool resize(const std::size_t size) {
+        cudaFree(_buffer);
+        cudaFree(_caseNum);
+        _buffer = nullptr;
+        _caseNum = nullptr;
+        _size = 0;
+        if (size == 0) {
+            return true;
+        }
+        if (!check(cudaMalloc(&_buffer, (inputCount + outputCount) * size * sizeof(Scalar)))) {
+            _buffer = nullptr;
+            return false;
+        }
+        if (!check(cudaMalloc(&_caseNum, size * sizeof(int)))) {
+            cudaFree(_buffer);
+            _buffer = nullptr;
+            _caseNum = nullptr;
+            return false;
+        }
+        _size = size;
+        return true;
+    }
+
+    std::size_t size() const noexcept {
+        return _size;
+    }
+
+    cudaError_t lastError() const noexcept {
+        return _lastError;
+    }
+
+    // Device arrays, for kernels that consume the profiles directly.
+    CudaTrajectoryBatchView<Scalar> view() const noexcept {
+        CudaTrajectoryBatchView<Scalar> b;
+        b.size = _size;
+        b.t0 = array(0);
+        b.p0 = array(1);
+        b.v0 = array(2);
+        b.pe = array(3);
+        b.ve = array(4);
+        b.amax = array(5);
+        b.vmax = array(6);
+        for (std::size_t k = 0; k < 3; ++k) {
+            b.dt[k] = array(inputCount + k);
+            b.a[k] = array(inputCount + 3 + k);
+            b.v[k] = array(inputCount + 6 + k);
+            b.p[k] = array(inputCount + 9 + k);
+            b.segmentEnd[k] = array(inputCount + 12 + k);
+        }
+        b.duration = array(inputCount + 15);
+        b.caseNum = _caseNum;
+        return b;
+    }
+
+    // Copies size() profiles from host arrays. t0, v0 and ve may be null, in
+    // which case they are zero as in TwoPointInterpolation::init.
+    bool upload(const Scalar* p0, const Scalar* pe, const Scalar* amax, const Scalar* vmax,
+                const Scalar* t0 = nullptr, const Scalar* v0 = nullptr, const Scalar* ve = nullptr,
+                cudaStream_t stream = 0) {
+        const std::size_t bytes = _size * sizeof(Scalar);
+        const Scalar* inputs[inputCount] = {t0, p0, v0, pe, ve, amax, vmax};
+        for (std::size_t k = 0; k < inputCount; ++k) {
+            const bool copied = inputs[k]
+                ? check(cudaMemcpyAsync(array(k), inputs[k], bytes, cudaMemcpyHostToDevice, stream))
+                : check(cudaMemsetAsync(array(k), 0, bytes, stream));
+            if (!copied) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Solves every profile on the device.
+    bool calcTrajectory(cudaStream_t stream = 0) {
+        if (_size == 0) {
+            return true;
+        }
+        solveConstantAccBatchKernel<Scalar><<<gridSize(), blockSize, 0, stream>>>(view());
+        return check(cudaGetLastError());
+    }
+
+    // Samples every profile at time t into device arrays of size() elements.
+    bool getPoints(const Scalar t, Scalar* pos, Scalar* vel, Scalar* acc, cudaStream_t stream = 0) {
+        if (_size == 0) {
+            return true;
+        }
+        sampleConstantAccBatchKernel<Scalar><<<gridSize(), blockSize, 0, stream>>>(view(), t, pos, vel, acc);
+        return check(cudaGetLastError());
+    }
+
+    // Copies the durations and case numbers back to host arrays (either may
+    // be null) and waits for the stream.
+    bool download(Scalar* duration, int* caseNum, cudaStream_t stream = 0) {
+        if (duration && !check(cudaMemcpyAsync(duration, array(inputCount + 15), _size * sizeof(Scalar),
+                                               cudaMemcpyDeviceToHost, stream))) {
+            return false;
+        }
+        if (caseNum && !check(cudaMemcpyAsync(caseNum, _caseNum, _size * sizeof(int),
+                                              cudaMemcpyDeviceToHost, stream))) {
+            return false;
+        }
+        return check(cudaStreamSynchronize(stream));
+    }
+};
+
+typedef BasicTwoPointInterpolationCudaBatch<double> TwoPointInterpolationCudaBatch;
+typedef BasicTwoPointInterpolationCudaBatch<float> TwoPointInterpolationCudaBatchFloat;
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+#include "two_points_interpolation_constant_acc_batch.hpp"
+
+// Fixed set of worker threads running indexed tasks. run() hands out task
+// indices from a shared counter, so faster threads take over more tasks, and
+// the calling thread works as worker 0 until every task is done. Jobs are
+// passed by pointer, so running one does not allocate.
+class TrajectoryThreadPool {
+private:
+    typedef void (*Job)(void* context, std::size_t task, unsigned worker);
+
+    std::vector<std::thread> _threads;
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _finished;
+    std::uint64_t _generation;
+    unsigned _busy;
+    bool _stop;
+
+    Job _job;
+    void* _context;
+    std::size_t _taskCount;
+    std::atomic<std::size_t> _nextTask;
+
+    template <class F>
+    static void invoke(void* context, const std::size_t task, const unsigned worker) {
+        (*static_cast<F*>(context))(task, worker);
+    }
+
+    void work(const unsigned worker) {
+        for (std::size_t task = _nextTask.fetch_add(1); task < _taskCount; task = _nextTask.fetch_add(1)) {
+            _job(_context, task, worker);
+        }
+    }
+
+    void loop(const unsigned worker) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _start.wait(lock, [this, seen] { return _stop || _generation != seen; });
+                if (_stop) {
+                    return;
+                }
+                seen = _generation;
+            }
+            work(worker);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (--_busy == 0) {
+                    _finished.notify_one();
+                }
+            }
+        }
+    }
+
+public:
+    // threadCount includes the calling thread; 0 uses one thread per core.
+    explicit TrajectoryThreadPool(unsigned threadCount = 0)
+        : _generation(0), _busy(0), _stop(false), _job(nullptr), _context(nullptr), _taskCount(0), _nextTask(0) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned worker = 1; worker < threadCount; ++worker) {
+            _threads.emplace_back(&TrajectoryThreadPool::loop, this, worker);
+        }
+    }
+
+    ~TrajectoryThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _start.notify_all();
+        for (std::thread& thread : _threads) {
+            thread.join();
+        }
+    }
+
+    TrajectoryThreadPool(const TrajectoryThreadPool&) = delete;
+    TrajectoryThreadPool& operator=(const TrajectoryThreadPool&) = delete;
+
+    unsigned threadCount() const noexcept {
+        return static_cast<unsigned>(_threads.size()) + 1;
+    }
+
+    // Calls f(task, worker) for every task in [0, taskCount), with worker in
+    // [0, threadCount()) identifying the calling thread, and returns when all
+    // calls have finished. Not reentrant.
+    template <class F>
+    void run(const std::size_t taskCount, F& f) {
+        if (taskCount == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _job = &invoke<F>;
+            _context = &f;
+            _taskCount = taskCount;
+            _nextTask.store(0);
+            _busy = static_cast<unsigned>(_threads.size());
+            ++_generation;
+        }
+        _start.notify_all();
+        work(0);
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [this] { return _busy == 0; });
+    }
+};
+
+// Solves and samples very large sets of independent moves on all cores.
+// The moves are cut into fixed chunks that are solved with the SoA batch
+// solver in a per-thread scratch TwoPointInterpolationBatch; the scratch
+// buffers are sized once, so nothing is allocated per call once chunkSize
+// moves fit. Every result is written to its own index, so the output does not
+// depend on the thread count or on scheduling.
+class ParallelTrajectoryPlanner {
+private:
+    TrajectoryThreadPool _pool;
+    std::size_t _chunkSize;
+    std::vector<TwoPointInterpolationBatch> _scratch; // one per worker
+    std::vector<double> _longest;                     // per worker, for the calcTrajectories result
+    std::vector<char> _infeasible;                    // per worker
+
+public:
+    static const std::size_t defaultChunkSize = 4096;
+
+    explicit ParallelTrajectoryPlanner(const unsigned threadCount = 0,
+                                       const std::size_t chunkSize = defaultChunkSize)
+        : _pool(threadCount), _chunkSize(std::max<std::size_t>(chunkSize, 1)) {
+        _scratch.resize(_pool.threadCount());
+        for (TwoPointInterpolationBatch& batch : _scratch) {
+            batch.resize(_chunkSize);
+        }
+        _longest.assign(_pool.threadCount(), 0.0);
+        _infeasible.assign(_pool.threadCount(), 0);
+    }
+
+    unsigned threadCount() const noexcept {
+        return _pool.threadCount();
+    }
+
+    // Solves count moves given as separate arrays (t0, v0 and ve may be null
+    // and then default to zero) into out and, if not null, caseNum. Results
+    // match TwoPointInterpolation bit for bit; infeasible moves get caseNum -1
+    // and no segments. Returns the longest duration, or -1 if any move is
+    // infeasible.
+    double calcTrajectories(const std::size_t count,
+                            const double* p0, const double* pe,
+                            const double* amax, const double* vmax,
+                            const double* t0, const double* v0, const double* ve,
+                            ConstantAccTrajectory* out, int* caseNum = nullptr) {
+        std::fill(_longest.begin(), _longest.end(), 0.0);
+        std::fill(_infeasible.begin(), _infeasible.end(), 0);
+        const std::size_t chunkSize = _chunkSize;
+        std::vector<TwoPointInterpolationBatch>& scratch = _scratch;
+        std::vector<double>& longest = _longest;
+        std::vector<char>& infeasible = _infeasible;
+        auto solveChunk = [&](const std::size_t chunk, const unsigned worker) {
+            const std::size_t begin = chunk * chunkSize;
+            const std::size_t n = std::min(chunkSize, count - begin);
+            TwoPointInterpolationBatch& batch = scratch[worker];
+            batch.resize(n);
+            for (std::size_t j = 0; j < n; ++j) {
+                const std::size_t i = begin + j;
+                batch.setAxis(j, p0[i], pe[i], amax[i], vmax[i],
+                              t0 ? t0[i] : 0.0, v0 ? v0[i] : 0.0, ve ? ve[i] : 0.0);
+            }
+            batch.calcTrajectory();
+            for (std::size_t j = 0; j < n; ++j) {
+                const std::size_t i = begin + j;
+                batch.getTrajectory(j, out[i]);
+                if (caseNum) {
+                    caseNum[i] = batch.caseNum(j);
+                }
+                if (batch.caseNum(j) < 0) {
+                    infeasible[worker] = 1;
+                } else if (batch.duration(j) > longest[worker]) {
+                    longest[worker] = batch.duration(j);
+                }
+            }
+        };
+        _pool.run((count + chunkSize - 1) / chunkSize, solveChunk);
+
+        double result = 0.0;
+        for (std::size_t w = 0; w < _longest.size(); ++w) {
+            if (_infeasible[w]) {
+                return -1;
+            }
+            result = std::max(result, _longest[w]);
+        }
+        return result;
+    }
+
+    // Samples count trajectories at the same time t into pos/vel/acc.
+    void getPoints(const ConstantAccTrajectory* trajectories, const std::size_t count, const double t,
+                   double* pos, double* vel, double* acc) {
+        const std::size_t chunkSize = _chunkSize;
+        auto sampleChunk = [&](const std::size_t chunk, unsigned) {
+            const std::size_t begin = chunk * chunkSize;
+            const std::size_t end = std::min(count, begin + chunkSize);
+            for (std::size_t i = begin; i < end; ++i) {
+                const TrajectoryPoint state = trajectories[i].getState(t);
+                pos[i] = state.pos;
+                vel[i] = state.vel;
+                acc[i] = state.acc;
+            }
+        };
+        _pool.run((count + chunkSize - 1) / chunkSize, sampleChunk);
+    }
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Hands solved profiles from one planner thread to any number of executor
+// threads without locks or allocation. The planner solves into its own
+// TwoPointInterpolation and publishes the resulting ConstantAccTrajectory;
+// readers copy out a consistent snapshot and sample it locally.
+//
+//   planner:  tpi.calcTrajectory(...); publisher.publish(tpi);
+//   executor: ConstantAccTrajectory snapshot;
+//             if (publisher.load(snapshot)) { state = snapshot.getState(t); }
+//
+// Two slots, each guarded by its own sequence counter, are written
+// alternately and the latest one is announced afterwards. A reader copies the
+// announced slot while the writer fills the other one, so it only has to
+// retry if two publications complete during a single copy. The snapshot is
+// stored as atomic words, so the copy is free of data races.
+class TrajectoryPublisher {
+public:
+    static const std::size_t wordCount = sizeof(ConstantAccTrajectory) / sizeof(std::uint64_t);
+
+private:
+    static_assert(std::is_trivially_copyable<ConstantAccTrajectory>::value,
+                  "ConstantAccTrajectory must be trivially copyable");
+    static_assert(sizeof(ConstantAccTrajectory) % sizeof(std::uint64_t) == 0,
+                  "ConstantAccTrajectory must be a whole number of 64-bit words");
+#if __cplusplus >= 201703L
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "TrajectoryPublisher requires lock-free 64-bit atomics");
+#endif
+
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> sequence; // odd while the slot is being written
+        std::array<std::atomic<std::uint64_t>, wordCount> words;
+    };
+
+    std::array<Slot, 2> _slots;
+    std::atomic<std::uint64_t> _version; // number of publications; the latest is in slot _version & 1
+
+public:
+    TrajectoryPublisher() noexcept {
+        for (std::size_t s = 0; s < _slots.size(); ++s) {
+            _slots[s].sequence.store(0, std::memory_order_relaxed);
+            for (std::size_t w = 0; w < wordCount; ++w) {
+                _slots[s].words[w].store(0, std::memory_order_relaxed);
+            }
+        }
+        _version.store(0, std::memory_order_release);
+    }
+
+    TrajectoryPublisher(const TrajectoryPublisher&) = delete;
+    TrajectoryPublisher& operator=(const TrajectoryPublisher&) = delete;
+
+    // Publishes a copy of trajectory. Must only be called from one thread at a time.
+    void publish(const ConstantAccTrajectory& trajectory) noexcept {
+        std::uint64_t words[wordCount];
+        std::memcpy(words, &trajectory, sizeof(words));
+
+        const std::uint64_t version = _version.load(std::memory_order_relaxed) + 1;
+        Slot& slot = _slots[version & 1];
+        const std::uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (std::size_t w = 0; w < wordCount; ++w) {
+            slot.words[w].store(words[w], std::memory_order_relaxed);
+        }
+        slot.sequence.store(sequence + 2, std::memory_order_release);
+        _version.store(version, std::memory_order_release);
+    }
+
+    void publish(const TwoPointInterpolation& interpolation) noexcept {
+        publish(interpolation.trajectory());
+    }
+
+    // Copies the latest published profile into out and returns its version.
+    // Returns 0, leaving out untouched, if nothing has been published yet.
+    std::uint64_t load(ConstantAccTrajectory& out) const noexcept {
+        std::uint64_t words[wordCount];
+        std::uint64_t version = 0;
+        for (;;) {
+            version = _version.load(std::memory_order_acquire);
+            if (version == 0) {
+                return 0;
+            }
+            const Slot& slot = _slots[version & 1];
+            const std::uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            for (std::size_t w = 0; w < wordCount; ++w) {
+                words[w] = slot.words[w].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == before) {
+                break;
+            }
+        }
+        std::memcpy(&out, words, sizeof(words));
+        return version;
+    }
+
+    // Number of profiles published so far; readers can compare it with the
+    // version returned by their last load() to skip copying an unchanged profile.
+    std::uint64_t version() const noexcept {
+        return _version.load(std::memory_order_acquire);
+    }
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define TWO_POINTS_INTERPOLATION_HAS_RDTSC 1
+#else
+#include <chrono>
+#define TWO_POINTS_INTERPOLATION_HAS_RDTSC 0
+#endif
+
+// Counters and latency histograms for TwoPointInterpolation, compiled in only
+// when TWO_POINTS_INTERPOLATION_ENABLE_STATS is defined (the solver header
+// then includes this file); without it the hooks do not exist at all.
+//
+// Every thread counts into its own block with plain relaxed loads and stores
+// (no locked instructions), so the hot paths never contend. A thread gets its
+// block from trajectoryStatsRegisterThread(), which locks and allocates and
+// so belongs in its start-up, before any real-time use. The hooks in the
+// solver only read a thread-local pointer and count nothing on threads that
+// never registered. trajectoryStatsSnapshot() sums all blocks, plus the counts
+// of threads that have already exited. Counters only grow: subtract two
+// snapshots to look at an interval.
+
+enum TrajectoryStatsCounter {
+    statsCalcTrajectory,  // calcTrajectory() calls
+    statsCase0,           // solved without reaching vmax
+    statsCase1,           // solved with a coast at vmax
+    statsInfeasible,      // calcTrajectory() returned -1
+    statsReplan,          // replan() calls that solved a new profile
+    statsReplanRejected,  // replan() returned -1
+    statsGetState,        // getState() / getPoint() calls
+    statsClampBefore,     // ... at a time before t0
+    statsClampAfter,      // ... at or after the end
+    statsCounterCount
+};
+
+enum TrajectoryStatsTimer {
+    statsCalcTrajectoryTimer,
+    statsGetStateTimer,
+    statsTimerCount
+};
+
+// Histogram bin k counts calls that took [2^k, 2^(k+1)) cycles (bin 0 also
+// takes 0 and 1). Cycles are TSC ticks on x86, nanoseconds elsewhere.
+static const std::size_t trajectoryStatsBins = 32;
+
+inline std::uint64_t trajectoryStatsCycles() noexcept {
+#if TWO_POINTS_INTERPOLATION_HAS_RDTSC
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+}
+
+struct TrajectoryStatsSnapshot {
+    std::uint64_t counters[statsCounterCount];
+    std::uint64_t histograms[statsTimerCount][trajectoryStatsBins];
+    std::uint64_t cycles[statsTimerCount]; // total over all timed calls
+
+    std::uint64_t count(const TrajectoryStatsCounter counter) const noexcept {
+        return counters[counter];
+    }
+
+    std::uint64_t timedCalls(const TrajectoryStatsTimer timer) const noexcept {
+        std::uint64_t calls = 0;
+        for (std::size_t k = 0; k < trajectoryStatsBins; ++k) {
+            calls += histograms[timer][k];
+        }
+        return calls;
+    }
+
+    // Upper bound (2^(k+1)) of the bin holding quantile q in [0, 1], or 0
+    // when nothing was timed.
+    std::uint64_t cyclesQuantile(const TrajectoryStatsTimer timer, const double q) const noexcept {
+        const std::uint64_t calls = timedCalls(timer);
+        if (calls == 0) {
+            return 0;
+        }
+        const double rank = q * static_cast<double>(calls);
+        std::uint64_t seen = 0;
+        for (std::size_t k = 0; k < trajectoryStatsBins; ++k) {
+            seen += histograms[timer][k];
+            if (static_cast<double>(seen) >= rank && seen > 0) {
+                return std::uint64_t(1) << (k + 1);
+            }
+        }
+        return std::uint64_t(1) << trajectoryStatsBins;
+    }
+};
+
+namespace two_points_interpolation_stats_detail {
+
+struct ThreadBlock;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadBlock*> threads;
+    TrajectoryStatsSnapshot retired = {};
+};
+
+inline Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+// Only its owning thread writes a block; snapshots read it concurrently,
+// hence the relaxed atomics.
+struct ThreadBlock {
+    std::atomic<std::uint64_t> counters[statsCounterCount];
+    std::atomic<std::uint64_t> histograms[statsTimerCount][trajectoryStatsBins];
+    std::atomic<std::uint64_t> cycles[statsTimerCount];
+
+    ThreadBlock() {
+        for (std::size_t c = 0; c < statsCounterCount; ++c) {
+            counters[c].store(0, std::memory_order_relaxed);
+        }
+        for (std::size_t t = 0; t < statsTimerCount; ++t) {
+            for (std::size_t k = 0; k < trajectoryStatsBins; ++k) {
+                histograms[t][k].store(0, std::memory_order_relaxed);
+            }
+            cycles[t].store(0, std::memory_order_relaxed);
+        }
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(this);
+    }
+
+    ~ThreadBlock();
+
+    ThreadBlock(const ThreadBlock&) = delete;
+    ThreadBlock& operator=(const ThreadBlock&) = delete;
+
+    void addTo(TrajectoryStatsSnapshot& out) const noexcept {
+        for (std::size_t c = 0; c < statsCounterCount; ++c) {
+            out.counters[c] += counters[c].load(std::memory_order_relaxed);
+        }
+        for (std::size_t t = 0; t < statsTimerCount; ++t) {
+            for (std::size_t k = 0; k < trajectoryStatsBins; ++k) {
+                out.histograms[t][k] += histograms[t][k].load(std::memory_order_relaxed);
+            }
+            out.cycles[t] += cycles[t].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+// Block of the calling thread, null until it registers. Constant-initialized,
+// so reading it needs no guard and cannot allocate.
+inline ThreadBlock*& local() noexcept {
+    thread_local ThreadBlock* block = nullptr;
+    return block;
+}
+
+inline ThreadBlock::~ThreadBlock() {
+    if (local() == this) {
+        local() = nullptr;
+    }
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    addTo(r.retired);
+    for (std::size_t i = 0; i < r.threads.size(); ++i) {
+        if (r.threads[i] == this) {
+            r.threads[i] = r.threads.back();
+            r.threads.pop_back();
+            break;
+        }
+    }
+}
+
+inline void add(std::atomic<std::uint64_t>& value, const std::uint64_t n) noexcept {
+    value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+inline std::size_t bin(std::uint64_t cycles) noexcept {
+    std::size_t k = 0;
+    while (cycles > 1 && k + 1 < trajectoryStatsBins) {
+        cycles >>= 1;
+        ++k;
+    }
+    return k;
+}
+
+} // namespace two_points_interpolation_stats_detail
+
+// Gives the calling thread its counters; until then the hooks skip it. Takes
+// the registry lock and allocates, so call it when the thread starts, not on
+// a real-time path. Calling it again does nothing. The block lives until the
+// thread exits, when its counts move to the exited-threads total.
+inline void trajectoryStatsRegisterThread() {
+    using namespace two_points_interpolation_stats_detail;
+    thread_local ThreadBlock block;
+    local() = &block;
+}
+
+inline bool trajectoryStatsThreadRegistered() noexcept {
+    return two_points_interpolation_stats_detail::local() != nullptr;
+}
+
+inline void trajectoryStatsCount(const TrajectoryStatsCounter counter) noexcept {
+    using namespace two_points_interpolation_stats_detail;
+    ThreadBlock* const block = local();
+    if (block) {
+        add(block->counters[counter], 1);
+    }
+}
+
+inline void trajectoryStatsRecord(const TrajectoryStatsTimer timer, const std::uint64_t cycles) noexcept {
+    using namespace two_points_interpolation_stats_detail;
+    ThreadBlock* const block = local();
+    if (block) {
+        add(block->histograms[timer][bin(cycles)], 1);
+        add(block->cycles[timer], cycles);
+    }
+}
+
+// Times its scope into one of the histograms.
+class TrajectoryStatsScope {
+private:
+    TrajectoryStatsTimer _timer;
+    std::uint64_t _start;
+
+public:
+    explicit TrajectoryStatsScope(const TrajectoryStatsTimer timer) noexcept
+        : _timer(timer), _start(trajectoryStatsCycles()) {}
+
+    ~TrajectoryStatsScope() noexcept {
+        trajectoryStatsRecord(_timer, trajectoryStatsCycles() - _start);
+    }
+
+    TrajectoryStatsScope(const TrajectoryStatsScope&) = delete;
+    TrajectoryStatsScope& operator=(const TrajectoryStatsScope&) = delete;
+};
+
+// Sum over all threads, including exited ones.
+inline TrajectoryStatsSnapshot trajectoryStatsSnapshot() {
+    using namespace two_points_interpolation_stats_detail;
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    TrajectoryStatsSnapshot result = r.retired;
+    for (const ThreadBlock* block : r.threads) {
+        block->addTo(result);
+    }
+    return result;
+}
+
+// Counts of the calling thread only (all zero if it never registered).
+inline TrajectoryStatsSnapshot trajectoryStatsThreadSnapshot() {
+    TrajectoryStatsSnapshot result = {};
+    using namespace two_points_interpolation_stats_detail;
+    const ThreadBlock* const block = local();
+    if (block) {
+        block->addTo(result);
+    }
+    return result;
+}
+
+inline const char* trajectoryStatsCounterName(const TrajectoryStatsCounter counter) noexcept {
+    static const char* const names[statsCounterCount] = {
+        "calcTrajectory", "case0", "case1", "infeasible", "replan", "replanRejected",
+        "getState", "clampBefore", "clampAfter"};
+    return names[counter];
+}
+
+inline const char* trajectoryStatsTimerName(const TrajectoryStatsTimer timer) noexcept {
+    static const char* const names[statsTimerCount] = {"calcTrajectory_cycles", "getState_cycles"};
+    return names[timer];
+}
+
+// Writes "name value" lines: every counter, then per timer the call count,
+// total cycles, p50/p99 bin bounds and "name <2^(k+1) count" for each
+// non-empty bin. Returns false when writing fails.
+inline bool writeTrajectoryStats(std::FILE* out, const TrajectoryStatsSnapshot& stats) {
+    bool ok = true;
+    for (std::size_t c = 0; c < statsCounterCount; ++c) {
+        const TrajectoryStatsCounter counter = static_cast<TrajectoryStatsCounter>(c);
+        ok = ok && std::fprintf(out, "%s %llu\n", trajectoryStatsCounterName(counter),
+                                static_cast<unsigned long long>(stats.count(counter))) > 0;
+    }
+    for (std::size_t t = 0; t < statsTimerCount; ++t) {
+        const TrajectoryStatsTimer timer = static_cast<TrajectoryStatsTimer>(t);
+        const char* name = trajectoryStatsTimerName(timer);
+        ok = ok && std::fprintf(out, "%s calls %llu total %llu p50 %llu p99 %llu\n", name,
+                                static_cast<unsigned long long>(stats.timedCalls(timer)),
+                                static_cast<unsigned long long>(stats.cycles[t]),
+                                static_cast<unsigned long long>(stats.cyclesQuantile(timer, 0.5)),
+                                static_cast<unsigned long long>(stats.cyclesQuantile(timer, 0.99))) > 0;
+        for (std::size_t k = 0; k < trajectoryStatsBins; ++k) {
+            if (stats.histograms[t][k] != 0) {
+                ok = ok && std::fprintf(out, "%s <%llu %llu\n", name,
+                                        static_cast<unsigned long long>(std::uint64_t(1) << (k + 1)),
+                                        static_cast<unsigned long long>(stats.histograms[t][k])) > 0;
+            }
+        }
+    }
+    return ok;
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Reference to a trajectory in a TrajectoryStore. Stays valid until the
+// trajectory is removed or the store is reset; a stale handle is detected,
+// never silently redirected to another trajectory.
+struct TrajectoryHandle {
+    std::uint64_t generation; // 0 never refers to a trajectory
+    std::uint32_t index;
+
+    bool isNull() const noexcept {
+        return generation == 0;
+    }
+};
+
+// Pool of solved profiles for very many moves (one per agent and leg).
+// Trajectories live in one contiguous array of cache-line sized slots with
+// their constraints in parallel arrays, so iterating them walks memory in
+// order, and a slot is reused after remove() or reset() without touching the
+// heap once the store has grown to its working size.
+//
+// Every insert gets a generation from a store-wide counter, so reset() can
+// drop everything of a planning epoch in O(1) and old handles still fail.
+class TrajectoryStore {
+private:
+    std::vector<ConstantAccTrajectory> _trajectories;
+    std::vector<std::uint64_t> _generations; // 0 for free slots
+    std::vector<double> _amax;
+    std::vector<double> _vmax;
+    std::vector<std::uint32_t> _free;
+    std::size_t _slotCount;
+    std::size_t _liveCount;
+    std::uint64_t _lastGeneration;
+
+    static ConstantAccTrajectory emptyTrajectory() noexcept {
+        ConstantAccTrajectory empty = ConstantAccTrajectory();
+        empty.clearSegments();
+        return empty;
+    }
+
+public:
+    explicit TrajectoryStore(const std::size_t capacity = 0)
+        : _slotCount(0), _liveCount(0), _lastGeneration(0) {
+        reserve(capacity);
+    }
+
+    void reserve(const std::size_t capacity) {
+        _trajectories.reserve(capacity);
+        _generations.reserve(capacity);
+        _amax.reserve(capacity);
+        _vmax.reserve(capacity);
+        _free.reserve(capacity);
+    }
+
+    // Adds a solved profile (with the constraints it was planned with, for
+    // replan()).
+    TrajectoryHandle insert(const ConstantAccTrajectory& trajectory, const double amax = 0, const double vmax = 0) {
+        std::uint32_t index = 0;
+        if (!_free.empty()) {
+            index = _free.back();
+            _free.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(_slotCount++);
+            if (index == _trajectories.size()) {
+                _trajectories.push_back(trajectory);
+                _generations.push_back(0);
+                _amax.push_back(0);
+                _vmax.push_back(0);
+            }
+        }
+        _trajectories[index] = trajectory;
+        _amax[index] = amax;
+        _vmax[index] = vmax;
+        _generations[index] = ++_lastGeneration;
+        ++_liveCount;
+        TrajectoryHandle handle = {_generations[index], index};
+        return handle;
+    }
+
+    // Solves a move straight into a slot. Returns a null handle if it has no
+    // solution.
+    TrajectoryHandle plan(const double p0, const double pe, const double amax, const double vmax,
+                          const double t0 = 0, const double v0 = 0, const double ve = 0) {
+        ConstantAccTrajectory trajectory = ConstantAccTrajectory();
+        trajectory.t0 = t0;
+        trajectory.p0 = p0;
+        trajectory.v0 = v0;
+        trajectory.pe = pe;
+        trajectory.ve = ve;
+        double aSigned = 0.0;
+        if (solveConstantAccTrajectory(trajectory, amax, vmax, aSigned) < 0) {
+            TrajectoryHandle null = {0, 0};
+            return null;
+        }
+        return insert(trajectory, amax, vmax);
+    }
+
+    // Same for a rotary axis, planned as TwoAngleInterpolation does; sampled
+    // positions are unwrapped (pass them through normalizeAxis).
+    TrajectoryHandle planAngle(const double p0, const double pe, const double amax, const double vmax,
+                               const double t0 = 0, const double v0 = 0, const double ve = 0) {
+        const double p0n = normalizeAxis(p0);
+        const double dp = normalizeAxis(normalizeAxis(pe) - p0n);
+        return plan(p0n, p0n + dp, amax, vmax, t0, v0, ve);
+    }
+
+    // Frees the slot of handle; false if the handle is stale.
+    bool remove(const TrajectoryHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        _generations[handle.index] = 0;
+        _trajectories[handle.index] = emptyTrajectory();
+        _free.push_back(handle.index);
+        --_liveCount;
+        return true;
+    }
+
+    // Drops every trajectory at once, keeping the memory for the next epoch.
+    // All handles issued so far become stale.
+    void reset() noexcept {
+        _slotCount = 0;
+        _liveCount = 0;
+        _free.clear();
+    }
+
+    bool contains(const TrajectoryHandle handle) const noexcept {
+        return handle.generation != 0 && handle.index < _slotCount
+            && _generations[handle.index] == handle.generation;
+    }
+
+    // Trajectory of handle, or null if the handle is stale.
+    const ConstantAccTrajectory* get(const TrajectoryHandle handle) const noexcept {
+        return contains(handle) ? &_trajectories[handle.index] : nullptr;
+    }
+
+    // State of handle at time t; false if the handle is stale.
+    bool getState(const TrajectoryHandle handle, const double t, TrajectoryPoint& out) const noexcept {
+        if (!contains(handle)) {
+            return false;
+        }
+        out = _trajectories[handle.index].getState(t);
+        return true;
+    }
+
+    // TwoPointInterpolation::replan on the trajectory of handle, in place;
+    // the handle stays valid. Returns the new duration or -1 (stale handle
+    // or no solution, the old profile is kept).
+    double replan(const TrajectoryHandle handle, const double t, const double pe, const double ve = 0,
+                  const double tolerance = 0) {
+        if (!contains(handle)) {
+            return -1;
+        }
+        TwoPointInterpolation planner;
+        planner.setTrajectory(_trajectories[handle.index], _amax[handle.index], _vmax[handle.index]);
+        const double duration = planner.replan(t, pe, ve, tolerance);
+        if (duration >= 0) {
+            _trajectories[handle.index] = planner.trajectory();
+        }
+        return duration;
+    }
+
+    // Number of live trajectories.
+    std::size_t size() const noexcept {
+        return _liveCount;
+    }
+
+    // Slots in use or freed since the last reset; trajectories() and the
+    // bulk sampler cover this range.
+    std::size_t slotCount() const noexcept {
+        return _slotCount;
+    }
+
+    bool isLive(const std::size_t index) const noexcept {
+        return index < _slotCount && _generations[index] != 0;
+    }
+
+    // Contiguous slots [0, slotCount()); free slots hold an empty profile
+    // that samples as position and velocity 0.
+    const ConstantAccTrajectory* trajectories() const noexcept {
+        return _trajectories.data();
+    }
+
+    // Samples every slot at the same time t into arrays of slotCount().
+    void getPoints(const double t, double* pos, double* vel, double* acc) const noexcept {
+        for (std::size_t i = 0; i < _slotCount; ++i) {
+            const TrajectoryPoint state = _trajectories[i].getState(t);
+            pos[i] = state.pos;
+            vel[i] = state.vel;
+            acc[i] = state.acc;
+        }
+    }
+
+    // Bytes held by the store, including capacity kept for later epochs.
+    std::size_t memoryUsage() const noexcept {
+        return _trajectories.capacity() * sizeof(ConstantAccTrajectory)
+            + _generations.capacity() * sizeof(std::uint64_t)
+            + (_amax.capacity() + _vmax.capacity()) * sizeof(double)
+            + _free.capacity() * sizeof(std::uint32_t);
+    }
+};
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Constant-acceleration trajectory through N waypoints. Every leg is solved
+// with the same closed form as TwoPointInterpolation, and the segments of all
+// legs are stored in one flat structure-of-arrays buffer with start times
+// relative to t0, so a long path is a single contiguous structure that is
+// queried by binary search (getState) or walked without search (Cursor).
+class WaypointTrajectory {
+private:
+    double _t0;
+    double _p0;
+    double _v0;
+    double _pe;
+    double _ve;
+    std::vector<double> _segmentStart; // segmentCount() + 1 entries; the last one is the total duration
+    std::vector<double> _a;
+    std::vector<double> _v;
+    std::vector<double> _p;
+    std::vector<std::size_t> _legFirstSegment; // legCount() + 1 entries
+
+public:
+    // Sequential reader for monotonically increasing times. Holds a pointer
+    // to the trajectory, which must outlive it and not be replanned meanwhile.
+    class Cursor {
+    private:
+        const WaypointTrajectory* _trajectory;
+        std::size_t _segment;
+
+    public:
+        explicit Cursor(const WaypointTrajectory& trajectory) noexcept
+            : _trajectory(&trajectory), _segment(0) {}
+
+        // State at t; advances past segments that ended before t. Times
+        // earlier than the previous query restart the scan from the start.
+        TrajectoryPoint getState(const double t) noexcept {
+            const WaypointTrajectory& w = *_trajectory;
+            const double tau = t - w._t0;
+            if (tau < 0 || w._a.empty()) {
+                _segment = 0;
+                return w.getState(t);
+            }
+            if (tau >= w.duration()) {
+                return w.getState(t);
+            }
+            if (_segment > 0 && !(tau > w._segmentStart[_segment])) {
+                _segment = 0;
+            }
+            while (tau > w._segmentStart[_segment + 1]) {
+                ++_segment;
+            }
+            return w.evaluate(_segment, tau);
+        }
+    };
+
+    WaypointTrajectory() : _t0(0.0), _p0(0.0), _v0(0.0), _pe(0.0), _ve(0.0) {
+        _segmentStart.push_back(0.0);
+        _legFirstSegment.push_back(0);
+    }
+
+    // Plans count waypoints starting at time t0. velocities, if given, holds
+    // the velocity at every waypoint (count entries); otherwise the path stops
+    // at each waypoint. Legs between identical waypoints with zero velocity
+    // are skipped. Returns the total duration, or -1 if a leg has no solution
+    // (the trajectory is then left empty). As in replan(), that includes legs
+    // whose solution has a negative phase: a via velocity that the next
+    // waypoint is too close to absorb without overshoot. Such a phase would
+    // make the segment start times decrease.
+    double calcTrajectory(const double* positions, const std::size_t count,
+                          const double amax, const double vmax,
+                          const double t0 = 0, const double* velocities = nullptr) {
+        clear();
+        if (count == 0) {
+            return -1;
+        }
+        _t0 = t0;
+        _p0 = positions[0];
+        _v0 = velocities ? velocities[0] : 0.0;
+        _pe = positions[count - 1];
+        _ve = velocities ? velocities[count - 1] : 0.0;
+
+        const std::size_t legs = count - 1;
+        _segmentStart.reserve(legs * ConstantAccTrajectory::maxSegments + 1);
+        _a.reserve(legs * ConstantAccTrajectory::maxSegments);
+        _v.reserve(legs * ConstantAccTrajectory::maxSegments);
+        _p.reserve(legs * ConstantAccTrajectory::maxSegments);
+        _legFirstSegment.reserve(legs + 1);
+
+        ConstantAccTrajectory leg{};
+        for (std::size_t i = 0; i < legs; ++i) {
+            leg.t0 = 0.0;
+            leg.p0 = positions[i];
+            leg.pe = positions[i + 1];
+            leg.v0 = velocities ? velocities[i] : 0.0;
+            leg.ve = velocities ? velocities[i + 1] : 0.0;
+            if (leg.p0 == leg.pe && leg.v0 == 0.0 && leg.ve == 0.0) {
+                _legFirstSegment.push_back(_a.size());
+                continue;
+            }
+            double aSigned = 0.0;
+            bool valid = solveConstantAccTrajectory(leg, amax, vmax, aSigned) >= 0;
+            for (std::size_t k = 0; k < leg.segmentCount; ++k) {
+                valid = valid && leg.dt[k] >= 0;
+            }
+            if (!valid) {
+                clear();
+                return -1;
+            }
+            const double legStart = _segmentStart.back();
+            for (std::size_t k = 0; k < leg.segmentCount; ++k) {
+                _a.push_back(leg.a[k]);
+                _v.push_back(leg.v[k]);
+                _p.push_back(leg.p[k]);
+                _segmentStart.push_back(legStart + leg.segmentStart[k + 1]);
+            }
+            _legFirstSegment.push_back(_a.size());
+        }
+        return duration();
+    }
+
+    double calcTrajectory(const std::vector<double>& positions,
+                          const double amax, const double vmax,
+                          const double t0 = 0,
+                          const std::vector<double>& velocities = std::vector<double>()) {
+        return calcTrajectory(positions.data(), positions.size(), amax, vmax, t0,
+                              velocities.size() == positions.size() ? velocities.data() : nullptr);
+    }
+
+    void clear() {
+        _segmentStart.assign(1, 0.0);
+        _a.clear();
+        _v.clear();
+        _p.clear();
+        _legFirstSegment.assign(1, 0);
+    }
+
+    double duration() const noexcept {
+        return _segmentStart.back();
+    }
+
+    std::size_t segmentCount() const noexcept {
+        return _a.size();
+    }
+
+    std::size_t legCount() const noexcept {
+        return _legFirstSegment.size() - 1;
+    }
+
+    // Time, relative to t0, at which leg i starts (i == legCount() gives the end).
+    double legStartTime(const std::size_t i) const noexcept {
+        return _segmentStart[_legFirstSegment[i]];
+    }
+
+    Cursor cursor() const noexcept {
+        return Cursor(*this);
+    }
+
+    TrajectoryPoint getState(const double t) const noexcept {
+        const double tau = t - _t0;
+        TrajectoryPoint result;
+        if (tau < 0) {
+            result.pos = _p0;
+            result.vel = _v0;
+            result.acc = 0.0;
+        } else if (tau >= duration()) {
+            result.pos = _pe;
+            result.vel = _ve;
+            result.acc = 0.0;
+        } else {
+            const std::vector<double>::const_iterator end =
+                std::lower_bound(_segmentStart.begin() + 1, _segmentStart.end(), tau);
+            result = evaluate(static_cast<std::size_t>(end - _segmentStart.begin()) - 1, tau);
+        }
+        return result;
+    }
+
+private:
+    TrajectoryPoint evaluate(const std::size_t i, const double tau) const noexcept {
+        const double t_in = tau - _segmentStart[i];
+        TrajectoryPoint result;
+        result.pos = pInteg(_p[i], _v[i], _a[i], t_in);
+        result.vel = vInteg(_v[i], _a[i], t_in);
+        result.acc = _a[i];
+        return result;
+    }
+};
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include "two_points_interpolation_constant_acc.hpp"
+
+// Jerk-limited (S-curve) profiles: seven constant-jerk segments, solved once
+// into a segment table that getState() evaluates without branching on the
+// regime.
+//
+// Not everything is closed form. Cruising at vmax, and the regime where both
+// velocity ramps reach amax, are solved directly (a quadratic in the peak
+// velocity). When one or both ramps stay below amax, the distance equation
+// holds a square root per ramp, sqrt((vp - v0) / jmax) and sqrt((vp - ve) /
+// jmax). Squaring them out gives a quartic whose closed-form roots lose far
+// more precision than they save time. Those regimes use a bisection for the
+// peak velocity instead, over [max(v0, ve), vmax]. The distance grows
+// monotonically with the peak across all regimes, so the bracket needs no
+// splitting by regime. The bisection stops as soon as the midpoint no longer
+// splits the bracket, which takes 44 to 58 steps on random moves of all
+// scales. The cap of peakVelocityIterations (200) bounds the rare bracket
+// that straddles zero, where doubles are densest. There it leaves at most
+// (vmax - max(v0, ve)) * 2^-200 of velocity error, far below the rounding of
+// the segment times.
+
+constexpr double aIntegJerk(const double a0, const double j, const double dt) {
+    return a0 + j * dt;
+}
+
+constexpr double vIntegJerk(const double v0, const double a0, const double j, const double dt) {
+    return v0 + a0 * dt + 0.5 * j * dt * dt;
+}
+
+constexpr double pIntegJerk(const double p0, const double v0, const double a0, const double j, const double dt) {
+    return p0 + v0 * dt + 0.5 * a0 * dt * dt + j * dt * dt * dt / 6.0;
+}
+
+// Solved jerk-limited (S-curve) profile in segment form. Segment i starts at
+// t0 + segmentStart[i] with acceleration a[i], velocity v[i] and position
+// p[i] and runs for dt[i] at constant jerk j[i]. There are always seven
+// segments (jerk up, constant acc, jerk down, cruise, jerk down, constant
+// decel, jerk up); the ones a profile does not need have zero length.
+struct alignas(64) ConstantJerkTrajectory {
+    static const std::size_t maxSegments = 7;
+
+    double t0;
+    double duration;
+    std::size_t segmentCount;
+    std::array<double, maxSegments + 1> segmentStart; // relative to t0; segmentStart[segmentCount] == duration
+    std::array<double, maxSegments> j;
+    std::array<double, maxSegments> a;
+    std::array<double, maxSegments> v;
+    std::array<double, maxSegments> p;
+    std::array<double, maxSegments> dt;
+    double p0;
+    double v0;
+    double pe;
+    double ve;
+
+    void clearSegments() noexcept {
+        segmentCount = 0;
+        segmentStart[0] = 0.0;
+        duration = 0.0;
+    }
+
+    // Appends a segment starting from the end state of the previous one (or
+    // from p0/v0 with zero acceleration for the first).
+    void addSegment(const double dtSeg, const double jSeg) noexcept {
+        const std::size_t i = segmentCount;
+        if (i == 0) {
+            a[0] = 0.0;
+            v[0] = v0;
+            p[0] = p0;
+        } else {
+            a[i] = aIntegJerk(a[i - 1], j[i - 1], dt[i - 1]);
+            v[i] = vIntegJerk(v[i - 1], a[i - 1], j[i - 1], dt[i - 1]);
+            p[i] = pIntegJerk(p[i - 1], v[i - 1], a[i - 1], j[i - 1], dt[i - 1]);
+        }
+        dt[i] = dtSeg;
+        j[i] = jSeg;
+        segmentStart[i + 1] = segmentStart[i] + dtSeg;
+        ++segmentCount;
+        duration = segmentStart[segmentCount];
+    }
+
+    TrajectoryPoint getState(const double t) const noexcept {
+        const double tau = t - t0;
+        TrajectoryPoint result;
+        if (tau < 0) {
+            result.pos = p0;
+            result.vel = v0;
+            result.acc = 0.0;
+        } else if (tau >= duration) {
+            result.pos = pe;
+            result.vel = ve;
+            result.acc = 0.0;
+        } else {
+            const std::size_t i = findSegment(tau);
+            const double t_in = tau - segmentStart[i];
+            result.pos = pIntegJerk(p[i], v[i], a[i], j[i], t_in);
+            result.vel = vIntegJerk(v[i], a[i], j[i], t_in);
+            result.acc = aIntegJerk(a[i], j[i], t_in);
+        }
+        return result;
+    }
+
+    // Index of the segment containing tau, for 0 <= tau < duration. A time
+    // exactly on a boundary belongs to the earlier segment.
+    std::size_t findSegment(const double tau) const noexcept {
+        std::size_t lo = 1;
+        std::size_t hi = segmentCount + 1;
+        while (lo < hi) {
+            const std::size_t mid = lo + (hi - lo) / 2;
+            if (segmentStart[mid] < tau) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        return lo - 1;
+    }
+};
+
+// Jerk-limited sibling of TwoPointInterpolation with the same interface: the
+// acceleration ramps at +-jmax instead of stepping, so the profile is C2
+// continuous in position. Acceleration is zero at both ends.
+class TwoPointInterpolationConstantJerk {
+private:
+    // Bisection steps solvePeakVelocity() may take, see the top of the file.
+    static const int peakVelocityIterations = 200;
+
+    bool _pointSetted;
+    bool _constraintsSetted;
+    bool _initialStateSetted;
+    bool _trajectoryCalced;
+    bool _verbose;
+    TwoPointInterpolationTraceCallback _traceCallback;
+    void* _traceUser;
+
+    double _amax;
+    double _vmax;
+    double _jmax;
+    double _vPeak;
+    int _caseNum;
+    ConstantJerkTrajectory _trajectory; // also holds the boundary state t0, p0, v0, pe, ve
+
+public:
+    TwoPointInterpolationConstantJerk(const bool verbose = false) {
+        _pointSetted = false;
+        _constraintsSetted = false;
+        _initialStateSetted = false;
+        _trajectoryCalced = false;
+        _verbose = verbose;
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+        _traceCallback = printTwoPointInterpolationTrace;
+#else
+        _traceCallback = nullptr;
+#endif
+        _traceUser = nullptr;
+        _trajectory = ConstantJerkTrajectory();
+        _trajectory.clearSegments();
+    }
+
+    void setInitial(const double t0, const double p0, const double v0 = 0) {
+        _trajectory.t0 = t0;
+        _trajectory.p0 = p0;
+        _trajectory.v0 = v0;
+        _initialStateSetted = true;
+    }
+
+    void setPoint(const double pe, const double ve = 0) {
+        _trajectory.pe = pe;
+        _trajectory.ve = ve;
+        _pointSetted = true;
+    }
+
+    void setConstraints(const double amax, const double vmax, const double jmax) {
+        _amax = amax;
+        _vmax = vmax;
+        _jmax = jmax;
+        _constraintsSetted = true;
+    }
+
+    // See TwoPointInterpolation::setTraceCallback.
+    void setTraceCallback(const TwoPointInterpolationTraceCallback callback, void* user = nullptr) {
+        _traceCallback = callback;
+        _traceUser = user;
+    }
+
+    bool isInitialized()
+    {
+        return _pointSetted && _constraintsSetted && _initialStateSetted && _trajectoryCalced;
+    }
+
+    void init(const double p0, const double pe,
+              const double amax, const double vmax, const double jmax,
+              const double t0 = 0, const double v0 = 0,
+              const double ve = 0) {
+        setInitial(t0, p0, v0);
+        setPoint(pe, ve);
+        setConstraints(amax, vmax, jmax);
+    }
+
+    // Returns the duration, or -1 when the limits are not positive, a
+    // boundary velocity exceeds vmax, or the distance is too short to change
+    // from v0 to ve without reversing.
+    //
+    // Working in the direction of travel, each velocity change from va to vb
+    // takes Ta = dv / amax + amax / jmax when amax is reached (dv >= amax^2 /
+    // jmax) and Ta = 2 * sqrt(dv / jmax) otherwise, and covers (va + vb) / 2 *
+    // Ta because the ramp is symmetric. The peak velocity vp is vmax with a
+    // cruise segment if that fits; otherwise it solves accel(v0 -> vp) +
+    // decel(vp -> ve) = dp, in closed form when both ramps reach amax (the
+    // distance is then quadratic in vp) and by bracketed bisection otherwise
+    // (see the top of the file).
+    double calcTrajectory() {
+        const double p0 = _trajectory.p0;
+        const double pe = _trajectory.pe;
+        const double dp = pe - p0;
+        const double s = dp < 0 ? -1.0 : 1.0;
+        const double distance = s * dp;
+        const double v0 = s * _trajectory.v0;
+        const double ve = s * _trajectory.ve;
+        const double A = _amax;
+        const double J = _jmax;
+        const double vmax = _vmax;
+
+        _trajectory.clearSegments();
+
+        if (!(A > 0) || !(J > 0) || !(vmax > 0) || std::fabs(v0) > vmax || std::fabs(ve) > vmax) {
+            traceError();
+            return -1;
+        }
+
+        const double vLow = v0 > ve ? v0 : ve;
+        if (rampDistance(v0, vLow) + rampDistance(ve, vLow) > distance) {
+            traceError();
+            return -1;
+        }
+
+        double vPeak = vmax;
+        double tCruise = 0.0;
+        const double dMax = rampDistance(v0, vmax) + rampDistance(ve, vmax);
+        if (dMax <= distance) {
+            _caseNum = 1;
+            tCruise = (distance - dMax) / vmax;
+        } else {
+            _caseNum = 0;
+            vPeak = solvePeakVelocity(v0, ve, vLow, vmax, distance);
+        }
+        _vPeak = s * vPeak;
+
+        double tj1 = 0.0;
+        double tc1 = 0.0;
+        rampTimes(vPeak - v0, tj1, tc1);
+        double tj2 = 0.0;
+        double tc2 = 0.0;
+        rampTimes(vPeak - ve, tj2, tc2);
+
+        const double j = s * J;
+        _trajectory.addSegment(tj1, j);
+        _trajectory.addSegment(tc1, 0.0);
+        _trajectory.addSegment(tj1, -j);
+        _trajectory.addSegment(tCruise, 0.0);
+        _trajectory.addSegment(tj2, -j);
+        _trajectory.addSegment(tc2, 0.0);
+        _trajectory.addSegment(tj2, j);
+
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+        if (_verbose && _traceCallback) {
+            const std::size_t n = _trajectory.segmentCount;
+            const double caseValue = _caseNum;
+            _traceCallback(_traceUser, "case", &caseValue, 1);
+            _traceCallback(_traceUser, "dt", _trajectory.dt.data(), n);
+            _traceCallback(_traceUser, "j", _trajectory.j.data(), n);
+            _traceCallback(_traceUser, "a", _trajectory.a.data(), n);
+            _traceCallback(_traceUser, "v", _trajectory.v.data(), n);
+            _traceCallback(_traceUser, "p", _trajectory.p.data(), n);
+        }
+#endif
+
+        _trajectoryCalced = true;
+
+        return _trajectory.duration;
+    }
+
+    double calcTrajectory(const double p0, const double pe,
+                          const double amax, const double vmax, const double jmax,
+                          const double t0 = 0, const double v0 = 0,
+                          const double ve = 0) {
+        init(p0, pe, amax, vmax, jmax, t0, v0, ve);
+        return calcTrajectory();
+    }
+
+    // Segment form of the current profile.
+    const ConstantJerkTrajectory& trajectory() const noexcept {
+        return _trajectory;
+    }
+
+    // 0: vmax not reached, 1: cruises at vmax.
+    int caseNum() const noexcept {
+        return _caseNum;
+    }
+
+    // Signed peak velocity of the current profile.
+    double peakVelocity() const noexcept {
+        return _vPeak;
+    }
+
+    TrajectoryPoint getState(const double t) const noexcept {
+        return _trajectory.getState(t);
+    }
+
+    void getPoint(const double t, TrajectoryPoint& out) const noexcept {
+        out = getState(t);
+    }
+
+    // Compatibility wrapper returning {pos, vel, acc}. Allocates; prefer
+    // getState() on real-time paths.
+    std::vector<double> getPoint(const double t) const {
+        const TrajectoryPoint state = getState(t);
+        std::vector<double> result = {state.pos, state.vel, state.acc};
+        return result;
+    }
+
+private:
+    void traceError() const {
+#ifdef TWO_POINTS_INTERPOLATION_ENABLE_TRACE
+        if (_verbose && _traceCallback) {
+            _traceCallback(_traceUser, "TwoPointInterpolationConstantJerk::calcTrajectory error", nullptr, 0);
+        }
+#endif
+    }
+
+    // Jerk and constant-acceleration phase lengths of a velocity change dv >= 0.
+    void rampTimes(const double dv, double& tj, double& tc) const {
+        if (dv * _jmax >= _amax * _amax) {
+            tj = _amax / _jmax;
+            tc = dv / _amax - tj;
+        } else {
+            tj = std::sqrt(dv / _jmax);
+            tc = 0.0;
+        }
+    }
+
+    // Distance covered while changing velocity between va and vb >= va.
+    double rampDistance(const double va, const double vb) const {
+        double tj = 0.0;
+        double tc = 0.0;
+        rampTimes(vb - va, tj, tc);
+        return 0.5 * (va + vb) * (2 * tj + tc);
+    }
+
+    double solvePeakVelocity(const double v0, const double ve,
+                             const double vLow, const double vHigh,
+                             const double distance) const {
+        const double A = _amax;
+        const double J = _jmax;
+        const double vSat = A * A / J;
+
+        // Both ramps reach amax: vp^2 / A + vp * A / J + K = 0.
+        const double K = (v0 + ve) * A / (2 * J) - (v0 * v0 + ve * ve) / (2 * A) - distance;
+        const double B = A * A / J;
+        const double D = B * B - 4 * K * A;
+        if (D >= 0) {
+            const double vp = 0.5 * (-B + std::sqrt(D));
+            if (vp - v0 >= vSat && vp - ve >= vSat && vp >= vLow && vp <= vHigh) {
+                return vp;
+            }
+        }
+
+        double lo = vLow;
+        double hi = vHigh;
+        for (int i = 0; i < peakVelocityIterations && lo < hi; ++i) {
+            const double mid = 0.5 * (lo + hi);
+            if (mid <= lo || mid >= hi) {
+                break;
+            }
+            if (rampDistance(v0, mid) + rampDistance(ve, mid) < distance) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return 0.5 * (lo + hi);
+    }
+};